@@ -0,0 +1,253 @@
+// Benchmark das filas de canal lock-free: vazão (mensagens/s) e latência de ida e volta.
+// Uso: channel_bench [mensagens]
+#include "broadcast_ring.h"
+#include "mpmc_queue.h"
+#include "shm_channel.h"
+#include "socket_channel.h"
+#include "spsc_ring.h"
+#include <chrono>
+#include <cstdlib>
+#include <fcntl.h>
+#include <sched.h>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+static const size_t ARITY = 2;
+static const size_t CAPACITY = 1024;
+
+// producers threads enviam `messages` mensagens no total; consumers threads as retiram
+template <class Queue>
+static double throughput(Queue &q, long messages, int producers, int consumers)
+{
+    std::vector<std::thread> threads;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int p = 0; p < producers; ++p)
+        threads.emplace_back([&q, messages, producers, p]
+                             {
+            Value msg[ARITY] = {Value::ofInt(p), Value()};
+            for (long k = p; k < messages; k += producers)
+            {
+                msg[1] = Value::ofInt((int)k);
+                while (!q.tryPush(msg, ARITY))
+                    std::this_thread::yield();
+            } });
+    for (int c = 0; c < consumers; ++c)
+        threads.emplace_back([&q, messages, consumers, c]
+                             {
+            std::vector<Value> msg;
+            for (long k = c; k < messages; k += consumers)
+                while (!q.tryPop(msg))
+                    std::this_thread::yield(); });
+    for (auto &t : threads)
+        t.join();
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    return secs > 0 ? (double)messages / secs : 0.0;
+}
+
+// Produtor num processo filho e consumidor neste, pelo anel em memória compartilhada (modo --processes)
+static double shmThroughput(long messages)
+{
+    ShmSegment segment(1, 1u << 20);
+    if (!segment.valid())
+        return 0.0;
+    segment.ring(0).header().limit = CAPACITY;
+    auto t0 = std::chrono::steady_clock::now();
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+        ShmChannel out(ARITY, {}, {segment.ring(0)});
+        for (long k = 0; k < messages; ++k)
+        {
+            Value msg[ARITY] = {Value::ofInt(0), Value::ofInt((int)k)};
+            while (!out.tryPush(msg, ARITY))
+                std::this_thread::yield();
+        }
+        _exit(0);
+    }
+    if (pid < 0)
+        return 0.0;
+    ShmChannel in(ARITY, {segment.ring(0)}, {});
+    std::vector<Value> msg;
+    for (long k = 0; k < messages; ++k)
+        while (!in.tryPop(msg))
+            std::this_thread::yield();
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    waitpid(pid, nullptr, 0);
+    return secs > 0 ? (double)messages / secs : 0.0;
+}
+
+// Difusão de `messages` mensagens a `readers` threads: por um anel de difusão (uma escrita por mensagem)
+// ou por um SpscRing por leitor (o produtor envia a mesma mensagem N vezes); retorna mensagens/s enviadas
+static double fanOut(long messages, int readers, bool broadcast)
+{
+    BroadcastRing ring(ARITY, CAPACITY);
+    ring.reset((size_t)readers);
+    std::vector<std::unique_ptr<SpscRing>> copies;
+    for (int r = 0; r < readers && !broadcast; ++r)
+        copies.emplace_back(new SpscRing(ARITY, CAPACITY));
+    std::vector<std::thread> threads;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int r = 0; r < readers; ++r)
+        threads.emplace_back([&, r]
+                             {
+            std::vector<Value> msg;
+            for (long k = 0; k < messages; ++k)
+                while (broadcast ? !ring.tryPop(msg, (size_t)r) : !copies[r]->tryPop(msg))
+                    std::this_thread::yield(); });
+    for (long k = 0; k < messages; ++k)
+    {
+        Value msg[ARITY] = {Value::ofInt(0), Value::ofInt((int)k)};
+        if (broadcast)
+            while (!ring.tryPush(msg, ARITY))
+                std::this_thread::yield();
+        else
+            for (auto &q : copies)
+                while (!q->tryPush(msg, ARITY))
+                    std::this_thread::yield();
+    }
+    for (auto &t : threads)
+        t.join();
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    return secs > 0 ? (double)messages / secs : 0.0;
+}
+
+// Como shmThroughput, por um socket Unix local (ouvinte criado aqui). flushEach envia cada mensagem
+// assim que escrita, para comparar com o envio em lote
+static double socketThroughput(long messages, bool flushEach)
+{
+    std::string path = "/tmp/minipar-bench-" + std::to_string(getpid()) + ".sock";
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    path.copy(addr.sun_path, sizeof addr.sun_path - 1);
+    int listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listenFd < 0 || bind(listenFd, reinterpret_cast<sockaddr *>(&addr), sizeof addr) < 0 || listen(listenFd, 1) < 0)
+    {
+        if (listenFd >= 0)
+            close(listenFd);
+        return 0.0;
+    }
+    fcntl(listenFd, F_SETFL, fcntl(listenFd, F_GETFL, 0) | O_NONBLOCK);
+    auto t0 = std::chrono::steady_clock::now();
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+        close(listenFd);
+        {
+            SocketChannel out(ARITY, -1, path, {}, nullptr);
+            for (long k = 0; k < messages; ++k)
+            {
+                Value msg[ARITY] = {Value::ofInt(0), Value::ofInt((int)k)};
+                while (!out.tryPush(msg, ARITY))
+                    out.flush();
+                if (flushEach)
+                    out.flush();
+            }
+        } // destrutor entrega o último lote
+        _exit(0);
+    }
+    double rate = 0.0;
+    if (pid > 0)
+    {
+        SocketChannel in(ARITY, listenFd, "", {}, nullptr);
+        std::vector<Value> msg;
+        for (long k = 0; k < messages; ++k)
+            while (!in.tryPop(msg))
+                std::this_thread::yield();
+        double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        waitpid(pid, nullptr, 0);
+        rate = secs > 0 ? (double)messages / secs : 0.0;
+    }
+    else
+        close(listenFd);
+    unlink(path.c_str());
+    return rate;
+}
+
+// Ida e volta entre duas threads por um par de filas; retorna a latência média de um sentido em ns.
+// Com yield, quem espera cede o núcleo a cada tentativa (num só núcleo o giro puro esgotaria a fatia do
+// escalonador antes de a outra thread rodar).
+template <class Queue>
+static double pingPong(long rounds, bool yield)
+{
+    auto wait = [yield]
+    {
+        if (yield)
+            std::this_thread::yield();
+    };
+    Queue ping(ARITY, CAPACITY), pong(ARITY, CAPACITY);
+    std::thread echo([&]
+                     {
+        std::vector<Value> msg;
+        for (long k = 0; k < rounds; ++k)
+        {
+            while (!ping.tryPop(msg))
+                wait();
+            while (!pong.tryPush(msg.data(), msg.size()))
+                wait();
+        } });
+    Value msg[ARITY] = {Value::ofInt(0), Value()};
+    std::vector<Value> reply;
+    auto t0 = std::chrono::steady_clock::now();
+    for (long k = 0; k < rounds; ++k)
+    {
+        msg[1] = Value::ofInt((int)k);
+        while (!ping.tryPush(msg, ARITY))
+            wait();
+        while (!pong.tryPop(reply))
+            wait();
+    }
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    echo.join();
+    return secs * 1e9 / (2.0 * (double)rounds);
+}
+
+// Núcleos em que o processo pode rodar (afinidade, como em taskset), não os da máquina
+static unsigned usableCores()
+{
+    cpu_set_t set;
+    if (sched_getaffinity(0, sizeof(set), &set) == 0)
+        return (unsigned)CPU_COUNT(&set);
+    return std::thread::hardware_concurrency();
+}
+
+int main(int argc, char *argv[])
+{
+    long messages = argc > 1 ? std::atol(argv[1]) : 2000000;
+    long rounds = messages / 20;
+    {
+        SpscRing q(ARITY, CAPACITY);
+        std::cout << "channel_bench: spsc 1p1c msgs/s=" << throughput(q, messages, 1, 1) << "\n";
+    }
+    {
+        MpmcQueue q(ARITY, CAPACITY);
+        std::cout << "channel_bench: mpmc 1p1c msgs/s=" << throughput(q, messages, 1, 1) << "\n";
+    }
+    {
+        MpmcQueue q(ARITY, CAPACITY);
+        std::cout << "channel_bench: mpmc 2p2c msgs/s=" << throughput(q, messages, 2, 2) << "\n";
+    }
+    std::cout << "channel_bench: broadcast 1p4c msgs/s=" << fanOut(messages / 4, 4, true) << "\n";
+    std::cout << "channel_bench: spsc x4 (mesma mensagem 4 vezes) msgs/s=" << fanOut(messages / 4, 4, false) << "\n";
+    std::cout << "channel_bench: shm 1p1c (processos) msgs/s=" << shmThroughput(messages) << "\n";
+    std::cout << "channel_bench: socket 1p1c (processos) msgs/s=" << socketThroughput(messages, false) << "\n";
+    std::cout << "channel_bench: socket 1p1c sem lote msgs/s=" << socketThroughput(messages / 10, true) << "\n";
+    // Com as duas threads em núcleos distintos a espera gira; num só núcleo cada ida e volta passa por
+    // trocas de contexto (yield), e o número mede isso, não a fila
+    bool yield = usableCores() <= 1;
+    if (yield)
+    {
+        rounds = rounds / 10 > 0 ? rounds / 10 : 1;
+        std::cout << "channel_bench: latência com yield (1 núcleo): inclui a troca de contexto entre as threads\n";
+    }
+    const char *mode = yield ? " wait=yield" : " wait=spin";
+    std::cout << "channel_bench: spsc latency_ns=" << pingPong<SpscRing>(rounds, yield) << mode << "\n";
+    std::cout << "channel_bench: mpmc latency_ns=" << pingPong<MpmcQueue>(rounds, yield) << mode << "\n";
+    return 0;
+}
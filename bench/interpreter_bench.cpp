@@ -0,0 +1,80 @@
+// Benchmark do interpretador TAC: mede instruções executadas por segundo num laço aritmético, com o TAC
+// do gerador (-O0) e depois dos passes de cada nível de otimização, e o tamanho do ambiente (slots).
+// Cada nível roda com o despacho por switch (antes) e por computed goto (depois), no mesmo binário.
+// Uso: interpreter_bench [iterações]
+#include "lexer.h"
+#include "parser.h"
+#include "tac_generator.h"
+#include "tac_interpreter.h"
+#include "tac_optimizer.h"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+int main(int argc, char *argv[])
+{
+    long iterations = argc > 1 ? std::atol(argv[1]) : 200000;
+    std::ostringstream src;
+    src << "SEQ\n"
+        << "  i = 0\n"
+        << "  s = 0\n"
+        << "  while (i < " << iterations << ") {\n"
+        << "    s = s + i * 2 - 1\n"
+        << "    if (s > 1000000) s = s - 1000000\n"
+        << "    i = i + 1\n"
+        << "  }\n"
+        << "  print s\n";
+
+    Lexer lexer(src.str());
+    auto tokens = lexer.tokenize();
+    Parser parser(tokens);
+    auto ast = parser.parse();
+
+    for (OptLevel level : {OptLevel::O0, OptLevel::O1, OptLevel::O2})
+    {
+        TACGenerator gen;
+        auto tac = gen.generate(ast.get());
+        PassManager(level).run(tac);
+        double rate[2] = {0.0, 0.0};
+        std::string output[2];
+        for (int threaded = 0; threaded < 2; ++threaded)
+        {
+            double best = 0.0;
+            unsigned long long executed = 0;
+            size_t slots = 0;
+            for (int run = 0; run < 3; ++run)
+            {
+                TACInterpreter interpreter;
+                interpreter.setSwitchDispatch(!threaded);
+                std::ostringstream out;
+                auto t0 = std::chrono::steady_clock::now();
+                interpreter.interpret(tac, out);
+                auto t1 = std::chrono::steady_clock::now();
+                double secs = std::chrono::duration<double>(t1 - t0).count();
+                executed = interpreter.executedInstructions();
+                slots = interpreter.slotCount();
+                output[threaded] = out.str();
+                if (run == 0 || secs < best)
+                    best = secs;
+            }
+            rate[threaded] = best > 0 ? (double)executed / best : 0.0;
+            std::cout << "interpreter_bench: -O" << (int)level << " dispatch=" << (threaded ? "goto" : "switch")
+                      << " iterations=" << iterations
+                      << " tac=" << tac.size()
+                      << " executed=" << executed
+                      << " slots=" << slots
+                      << " time=" << best << "s"
+                      << " instr/s=" << rate[threaded] << "\n";
+        }
+        if (output[0] != output[1])
+        {
+            std::cerr << "interpreter_bench: saídas diferentes entre os despachos em -O" << (int)level << "\n";
+            return 1;
+        }
+        std::cout << "interpreter_bench: -O" << (int)level << " goto/switch=" << (rate[0] > 0 ? rate[1] / rate[0] : 0.0)
+                  << "\n";
+    }
+    return 0;
+}
@@ -59,6 +59,8 @@ struct ChannelDeclNode : public ASTNode
     std::string name;
     std::string comp1;
     std::string comp2;
+    int capacity = 0; // mensagens em fila antes de send bloquear (0 = sem limite declarado)
+    bool broadcast = false; // cada mensagem vai a todos os ramos que recebem no canal
 
     void accept(ASTVisitor &visitor) override;
     std::string toString() const override;
@@ -115,6 +117,25 @@ struct ReceiveNode : public ASTNode
     std::string toString() const override;
 };
 
+// select { canal.receive(vars) { corpo } ... }: espera a primeira mensagem entre os canais e executa o
+// corpo do caso escolhido (casos prontos ao mesmo tempo são atendidos em rodízio)
+struct SelectNode : public ASTNode
+{
+    std::vector<std::unique_ptr<ReceiveNode>> cases;
+    std::vector<std::unique_ptr<SeqNode>> bodies; // paralelo a cases
+    void accept(ASTVisitor &visitor) override;
+    std::string toString() const override;
+};
+
+// global a, b: dentro de função, os nomes usam a variável de topo (sem isso todo nome atribuído no corpo é
+// local da chamada)
+struct GlobalDeclNode : public ASTNode
+{
+    std::vector<std::string> names;
+    void accept(ASTVisitor &visitor) override;
+    std::string toString() const override;
+};
+
 struct FunctionDeclNode : public ASTNode
 {
     std::string name;
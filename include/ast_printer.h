@@ -32,6 +32,8 @@ public:
     void visit(InputCallNode &node) override;
     void visit(SendNode &node) override;
     void visit(ReceiveNode &node) override;
+    void visit(SelectNode &node) override;
+    void visit(GlobalDeclNode &node) override;
     void visit(IfNode &node) override;
     void visit(WhileNode &node) override;
     void visit(BinaryOpNode &node) override;
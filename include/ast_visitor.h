@@ -13,6 +13,8 @@ struct InputNode;
 struct InputCallNode;
 struct SendNode;
 struct ReceiveNode;
+struct SelectNode;
+struct GlobalDeclNode;
 struct IfNode;
 struct WhileNode;
 struct BinaryOpNode;
@@ -45,6 +47,8 @@ public:
     virtual void visit(InputCallNode &node) = 0;
     virtual void visit(SendNode &node) = 0;
     virtual void visit(ReceiveNode &node) = 0;
+    virtual void visit(SelectNode &node) = 0;
+    virtual void visit(GlobalDeclNode &node) = 0;
     virtual void visit(IfNode &node) = 0;
     virtual void visit(WhileNode &node) = 0;
     virtual void visit(BinaryOpNode &node) = 0;
@@ -0,0 +1,78 @@
+#ifndef BROADCAST_RING_H
+#define BROADCAST_RING_H
+
+#include "runtime_value.h"
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// Fila lock-free de difusão (canal `broadcast`): cada mensagem é gravada uma única vez e todo assinante
+// a recebe, lendo com um cursor próprio. Produtores disputam a posição como em MpmcQueue; cada posição
+// guarda quantos assinantes ainda não passaram por ela, e o último a passar libera a posição para a
+// próxima volta (levando os valores em vez de copiá-los). Assinantes recebem cópias O(1) dos valores:
+// arrays são compartilhados por referência, com copy-on-write na escrita.
+// Assinante cujo ramo termina sai (leave): deixa de contar nas posições que não leu e nas publicadas
+// depois, senão o anel encheria à espera dele e todo produtor do canal ficaria bloqueado. O último a sair
+// mantém o cursor: o que ele não recebeu fica para os assinantes do bloco seguinte.
+class BroadcastRing
+{
+public:
+    BroadcastRing(size_t arity, size_t capacity);
+    BroadcastRing(const BroadcastRing &) = delete;
+    BroadcastRing &operator=(const BroadcastRing &) = delete;
+    ~BroadcastRing(); // libera as mensagens que nem todos receberam
+
+    // Início de bloco PAR, sem ramos rodando: `readers` assinantes, todos a partir da mensagem mais antiga
+    // ainda retida (o que algum assinante do bloco anterior não recebeu é entregue aos novos)
+    void reset(size_t readers);
+    // Índice do próximo assinante do bloco (cada ramo que recebe pega o seu na primeira recepção)
+    size_t subscribe() { return nextReader.fetch_add(1, std::memory_order_relaxed); }
+    // Fim do ramo dono do cursor `reader`: libera as posições que só esperavam por ele; false se era o
+    // último assinante do bloco (nada liberado)
+    bool leave(size_t reader);
+
+    // Assume a posse dos valores; false (posse mantida) se cheia. Valores além da aridade são descartados.
+    bool tryPush(Value *msg, size_t len);
+    // Apenas o ramo dono do cursor `reader`; false se já recebeu tudo o que foi publicado
+    bool tryPop(std::vector<Value> &msg, size_t reader);
+    // Consultas aproximadas
+    bool empty(size_t reader) const;
+    bool full() const;
+    size_t size() const; // mensagens que algum assinante ainda não recebeu
+    size_t arity() const { return width; }
+    size_t capacity() const { return cap; }
+    size_t subscribers() const { return readerCount; }
+
+private:
+    static constexpr size_t GONE = ~(size_t)0; // cursor de assinante que saiu
+
+    struct alignas(64) Cursor
+    {
+        std::atomic<size_t> pos; // escrito só pelo assinante; atômico para size() de outras threads
+        Cursor(size_t at = 0) : pos(at) {}
+        Cursor(const Cursor &other) : pos(other.pos.load(std::memory_order_relaxed)) {}
+        Cursor &operator=(const Cursor &other)
+        {
+            pos.store(other.pos.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            return *this;
+        }
+    };
+
+    Value *slot(size_t pos) { return buf.data() + (pos % cap) * (width + 1); }
+    void retire(size_t pos); // último assinante passou: libera os valores e a posição
+
+    std::vector<Value> buf;
+    std::unique_ptr<std::atomic<size_t>[]> sequence;  // por posição, como em MpmcQueue
+    std::unique_ptr<std::atomic<size_t>[]> remaining; // assinantes que ainda não leram a posição
+    std::unique_ptr<std::atomic<size_t>[]> goneAt;    // saídas já contadas quando a posição foi publicada
+    std::vector<Cursor> cursors;
+    size_t width;
+    size_t cap;
+    size_t readerCount = 0;
+    alignas(64) std::atomic<size_t> enqueuePos{0};
+    alignas(64) std::atomic<size_t> nextReader{0};
+    alignas(64) std::atomic<size_t> departed{0}; // assinantes do bloco que já saíram
+};
+
+#endif
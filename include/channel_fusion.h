@@ -0,0 +1,26 @@
+#ifndef CHANNEL_FUSION_H
+#define CHANNEL_FUSION_H
+
+#include "ast_nodes.h"
+#include <string>
+#include <vector>
+
+// Canal eliminado pela fusão produtor/consumidor
+struct FusedChannel
+{
+    std::string channel;
+    int par = 0;      // bloco PAR (ordem no programa)
+    int producer = 0; // índices dos ramos SEQ no bloco no momento desta fusão
+    int consumer = 0;
+};
+
+// Funde, em cada bloco PAR, pares 1:1 de ramos SEQ ligados por um canal sem capacidade declarada: o produtor
+// só envia nesse canal (fora canais privados), não chama funções nem lê entrada, e ou não imprime nada ou vem
+// logo antes do consumidor; o consumidor não lê nem escreve variável do produtor sem antes atribuí-la ele
+// mesmo no topo do ramo (os dois passam a dividir o ambiente). O produtor nunca espera ninguém, então rodar
+// produtor e depois consumidor num só SEQ é uma execução válida do PAR original; o canal vira fila local do
+// ramo, sem sincronização nem troca de contexto. Repete até não haver par a fundir (pipelines A -> B -> C
+// viram um só ramo).
+std::vector<FusedChannel> fuse_channel_pairs(ProgramNode *program);
+
+#endif
@@ -0,0 +1,69 @@
+#ifndef CHANNEL_METRICS_H
+#define CHANNEL_METRICS_H
+
+#include <atomic>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Tempos de espera (ns) num histograma de potências de dois: total e percentis sem guardar amostras.
+// O percentil é o limite superior do balde (erro de no máximo 2x, suficiente para achar o gargalo).
+class WaitHistogram
+{
+public:
+    static const int BUCKETS = 64;
+
+    void record(unsigned long long ns);
+    void merge(const WaitHistogram &other);
+    unsigned long long samples() const { return count.load(std::memory_order_relaxed); }
+    unsigned long long totalNs() const { return total.load(std::memory_order_relaxed); }
+    unsigned long long percentileNs(double p) const;
+
+private:
+    std::atomic<unsigned long long> buckets[BUCKETS]{};
+    std::atomic<unsigned long long> total{0};
+    std::atomic<unsigned long long> count{0};
+};
+
+// Métricas de um canal (contadores relaxados, lidos ao fim da execução). A profundidade da fila é
+// amostrada a cada envio; bloqueio é o tempo entre a primeira tentativa frustrada e a conclusão.
+struct ChannelMetrics
+{
+    std::atomic<unsigned long long> sent{0};
+    std::atomic<unsigned long long> received{0};
+    std::atomic<unsigned long long> peakDepth{0};
+    std::atomic<unsigned long long> depthSum{0};
+    WaitHistogram sendBlocked;
+    WaitHistogram recvBlocked;
+
+    void onSend(size_t depth);
+    void onReceive() { received.fetch_add(1, std::memory_order_relaxed); }
+    void merge(const ChannelMetrics &other);
+    double averageDepth() const;
+};
+
+// Métricas de canais privados de um ramo (filas locais do interpretador), somadas quando o ramo termina;
+// o mapa é montado antes da execução e só os contadores mudam depois
+using ChannelMetricsMap = std::unordered_map<std::string, std::unique_ptr<ChannelMetrics>>;
+
+enum class MetricsFormat
+{
+    TABLE,
+    JSON
+};
+
+struct ChannelMetricsRow
+{
+    std::string name;
+    std::string kind;
+    const ChannelMetrics *metrics;
+};
+
+// Tabela alinhada (uma linha por canal) ou um objeto JSON numa linha: {"component": ..., "channels": [...]}
+// (component só no modo --processes, quando não vazio)
+void print_channel_metrics(std::vector<ChannelMetricsRow> rows, MetricsFormat format, const std::string &component,
+                           std::ostream &out);
+
+#endif
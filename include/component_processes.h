@@ -0,0 +1,79 @@
+#ifndef COMPONENT_PROCESSES_H
+#define COMPONENT_PROCESSES_H
+
+#include "semantic_components.h"
+#include "shared_channel.h"
+#include "shm_channel.h"
+#include <functional>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Transporte dos canais entre componentes
+enum class ChannelTransport
+{
+    SHM,   // anéis em memória compartilhada (ShmChannel)
+    SOCKET // sockets Unix com escrita em lote (SocketChannel)
+};
+
+// Canais entre componentes, criados pelo processo pai antes dos forks. Cada canal tem um anel por
+// componente emissor numa única ShmSegment, com a capacidade do canal (mensagens); os anéis e o que
+// sobrar neles persistem entre blocos PAR, como as filas do modo de um processo. No transporte por
+// socket os anéis ficam só com o cabeçalho (marcas de processo encerrado) e o pai cria, num diretório
+// temporário, um socket de escuta por canal, herdado pelo processo receptor.
+class ComponentChannels
+{
+public:
+    static const size_t RING_BYTES = 4u << 20; // dados por anel (espaço de endereçamento; páginas sob demanda)
+
+    ComponentChannels(const ComponentLayout &layout, const std::unordered_map<std::string, int> &capacities,
+                      ChannelTransport transport = ChannelTransport::SHM);
+    ComponentChannels(const ComponentChannels &) = delete;
+    ComponentChannels &operator=(const ComponentChannels &) = delete;
+    ~ComponentChannels(); // fecha os sockets de escuta e remove seus caminhos
+
+    bool valid() const { return segment.valid() && listenFds.size() == channels.size(); }
+    // No processo do componente: troca os canais que cruzam componentes pela ponta compartilhada
+    // (mantendo a política de espera do canal substituído)
+    void attach(const std::string &component, const std::unordered_map<std::string, int> &arities,
+                SharedChannelMap &channels) const;
+    // Antes de cada bloco PAR: reabre os anéis e encerra de saída os lados de componentes sem processo
+    // no bloco (ninguém vai escrever ou ler por eles)
+    void beginBlock(const std::vector<std::string> &running);
+    // Processo do componente terminou, normalmente ou não: quem espera por ele é liberado
+    void markGone(const std::string &component);
+
+private:
+    std::vector<CrossChannel> channels;
+    std::vector<size_t> firstRing; // anel do primeiro emissor de cada canal
+    ChannelTransport transport;
+    ShmSegment segment;
+    std::string socketDir;       // diretório temporário dos sockets (transporte SOCKET)
+    std::vector<int> listenFds;  // por canal (-1 sem receptor ou no transporte SHM)
+    std::vector<std::string> socketPaths;
+};
+
+// Ramos de um bloco PAR que rodam no processo de um componente
+struct ComponentJob
+{
+    std::string component;
+    std::vector<size_t> branches;
+};
+
+// Executado no processo filho: preenche a saída de cada ramo do job (na ordem de job.branches) e um
+// relatório opcional do processo (estatísticas de runtime). false: erro de execução em algum ramo (já
+// reportado em stderr); o filho sai com código 1.
+using ComponentBody = std::function<bool(const ComponentJob &job, std::vector<std::string> &outputs,
+                                         std::string &report)>;
+
+// Um processo por job (fork). O filho devolve saídas e relatório ao pai por um pipe; o pai espera todos,
+// chama onExit ao fim de cada processo (inclusive por sinal, que também é reportado em err) e monta as
+// saídas por índice de ramo. pinCores fixa o job k no núcleo k módulo o número de núcleos.
+// O pai não pode ter threads vivas no fork (o filho herdaria só a thread que chamou): o ThreadPool
+// compartilhado deve nascer apenas nos filhos.
+bool run_component_processes(const std::vector<ComponentJob> &jobs, size_t branchCount, const ComponentBody &body,
+                             const std::function<void(const ComponentJob &)> &onExit, bool pinCores,
+                             std::vector<std::string> &outputs, std::vector<std::string> &reports, std::ostream &err);
+
+#endif
@@ -28,6 +28,10 @@ char* compile_minipar_json(const char* source_code);
 EMSCRIPTEN_KEEPALIVE
 void free_string(char* str);
 
+// Nível de otimização do TAC (0, 1 ou 2, como -O0/-O1/-O2) usado pelas funções acima; padrão 0
+EMSCRIPTEN_KEEPALIVE
+void set_optimization_level(int level);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,39 @@
+#ifndef FRAME_ARENA_H
+#define FRAME_ARENA_H
+
+#include "runtime_value.h"
+#include <memory>
+#include <vector>
+
+// Pilha de frames em arena: blocos grandes de Value alocados sob demanda e nunca movidos.
+// Empilhar/desempilhar um frame só ajusta o topo; blocos ficam retidos para reutilização.
+class FrameArena
+{
+public:
+    struct Mark
+    {
+        size_t chunk;
+        size_t top;
+    };
+
+    explicit FrameArena(size_t chunkValues = 1 << 14);
+
+    // Reserva n valores contíguos; `saved` recebe a posição anterior para o pop correspondente
+    Value *push(size_t n, Mark &saved);
+    // Volta ao topo salvo (o chamador libera antes os valores do frame)
+    void pop(const Mark &saved) { cur = saved.chunk, top = saved.top; }
+    void reset() { cur = 0, top = 0; }
+
+private:
+    struct Chunk
+    {
+        std::unique_ptr<Value[]> data;
+        size_t size;
+    };
+    std::vector<Chunk> chunks;
+    size_t chunkValues;
+    size_t cur = 0; // bloco corrente
+    size_t top = 0; // próxima posição livre no bloco corrente
+};
+
+#endif
@@ -20,6 +20,9 @@ enum TokenType
     TRUE,
     FALSE,
     COMP,
+    SELECT,
+    BROADCAST,
+    GLOBAL,
     // Tipos
     INT,
     BOOL,
@@ -0,0 +1,17 @@
+#ifndef MESSAGE_CODEC_H
+#define MESSAGE_CODEC_H
+
+#include "runtime_value.h"
+#include <cstddef>
+#include <vector>
+
+// Codificação binária compacta de mensagens de canal para transporte entre processos, onde handles
+// (texto internado, ArrayObj) não valem. Inteiros em little-endian:
+//   mensagem = [n: u32] valor*n
+//   valor    = [tag: u8] e, conforme a tag, INT [i32] | FLOAT [f64] | STR [len: u32][bytes] | ARRAY [n: u32] valor*n
+void encode_message(const Value *msg, size_t len, std::vector<unsigned char> &out); // acrescenta a out
+// Recria os valores (strings internadas, arrays novos com uma referência) em msg; false se os bytes
+// não formam exatamente uma mensagem (nada fica alocado nesse caso)
+bool decode_message(const unsigned char *data, size_t size, std::vector<Value> &msg);
+
+#endif
@@ -0,0 +1,43 @@
+#ifndef MESSAGE_RING_H
+#define MESSAGE_RING_H
+
+#include "runtime_value.h"
+#include <cstddef>
+#include <vector>
+
+// Fila FIFO de mensagens de canal num único buffer circular de Values.
+// Cada posição tem largura fixa (aridade do canal) precedida pelo tamanho real da mensagem,
+// então push/pop são O(1) e não alocam; o buffer só cresce (dobrando) quando enche, até o limite
+// declarado do canal, se houver. Os valores passam de dono para dono: arrays circulam como handles.
+class MessageRing
+{
+public:
+    // limit = 0: sem limite de mensagens
+    explicit MessageRing(size_t arity = 0, size_t capacity = 16, size_t limit = 0);
+    MessageRing(MessageRing &&other) noexcept;
+    MessageRing(const MessageRing &) = delete;
+    MessageRing &operator=(const MessageRing &) = delete;
+    ~MessageRing(); // libera as mensagens não recebidas
+
+    // Assume a posse dos valores; false (posse continua com quem chamou) se o canal é limitado e está cheio
+    bool push(Value *msg, size_t len);
+    // Move a mensagem mais antiga para `msg` (reaproveita a capacidade do vetor); false se vazia
+    bool pop(std::vector<Value> &msg);
+    bool empty() const { return count == 0; }
+    size_t size() const { return count; }
+    size_t arity() const { return width; }
+    bool full() const { return limit && count >= limit; }
+
+private:
+    void relayout(size_t newWidth, size_t newCapacity);
+    Value *slot(size_t k) { return buf.data() + k * (width + 1); }
+
+    std::vector<Value> buf; // capacity posições de (1 + width) valores: [tamanho, v0 .. v(width-1)]
+    size_t width;
+    size_t capacity;
+    size_t limit;
+    size_t head = 0;  // posição da mensagem mais antiga
+    size_t count = 0; // mensagens na fila
+};
+
+#endif
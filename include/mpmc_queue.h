@@ -0,0 +1,49 @@
+#ifndef MPMC_QUEUE_H
+#define MPMC_QUEUE_H
+
+#include "runtime_value.h"
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// Fila lock-free limitada de vários produtores e vários consumidores (caso geral de canal).
+// Cada posição tem um número de sequência que diz se está livre para a volta corrente do produtor
+// ou já publicada para o consumidor; produtores e consumidores só disputam o CAS do próprio índice.
+// A capacidade é exata (índice por módulo), pois canais declarados com limite bloqueiam nela.
+class MpmcQueue
+{
+public:
+    MpmcQueue(size_t arity, size_t capacity);
+    MpmcQueue(const MpmcQueue &) = delete;
+    MpmcQueue &operator=(const MpmcQueue &) = delete;
+    ~MpmcQueue(); // libera as mensagens não recebidas
+
+    // Assume a posse dos valores; false (posse mantida) se cheia. Valores além da aridade são descartados.
+    bool tryPush(Value *msg, size_t len);
+    // Move a mensagem para msg; false se vazia
+    bool tryPop(std::vector<Value> &msg);
+    // Consultas aproximadas
+    bool empty() const { return dequeuePos.load(std::memory_order_acquire) >= enqueuePos.load(std::memory_order_acquire); }
+    bool full() const { return enqueuePos.load(std::memory_order_acquire) - dequeuePos.load(std::memory_order_acquire) >= cap; }
+    size_t size() const
+    {
+        // Consumidor pode ter reservado uma posição que o produtor ainda não publicou
+        size_t in = enqueuePos.load(std::memory_order_acquire), out = dequeuePos.load(std::memory_order_acquire);
+        return in > out ? in - out : 0;
+    }
+    size_t arity() const { return width; }
+    size_t capacity() const { return cap; }
+
+private:
+    Value *slot(size_t pos) { return buf.data() + (pos % cap) * (width + 1); }
+
+    std::vector<Value> buf;
+    std::unique_ptr<std::atomic<size_t>[]> sequence; // por posição
+    size_t width;
+    size_t cap;
+    alignas(64) std::atomic<size_t> enqueuePos{0};
+    alignas(64) std::atomic<size_t> dequeuePos{0};
+};
+
+#endif
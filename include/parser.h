@@ -4,6 +4,7 @@
 #include "lexer.h"
 #include "ast_nodes.h"
 #include <memory>
+#include <unordered_set>
 #include <vector>
 
 class Parser
@@ -12,12 +13,17 @@ private:
     std::vector<Token> tokens;
     size_t current_token;
     std::string currentComponent;
+    bool inFunction = false; // corpo de `fun` em análise (global só vale ali)
+    std::vector<std::string> parseErrors;
+    std::unordered_set<std::string> broadcastChannels;
+    std::vector<std::pair<Token, std::string>> selectCases; // (início do caso, canal) de todo select
 
     Token &current();
     Token &peek();
     void consume();
     bool match(TokenType type);
     void setComponent(const std::string &name);
+    void error(const Token &at, const std::string &message);
 
     std::unique_ptr<ASTNode> parse_statement();
     std::unique_ptr<ASTNode> parse_expression();
@@ -27,11 +33,14 @@ private:
     std::unique_ptr<ASTNode> parse_primary();
     std::unique_ptr<ASTNode> parse_while_statement();
     std::unique_ptr<ASTNode> parse_if_statement();
+    std::unique_ptr<ASTNode> parse_select_statement();
     std::unique_ptr<SeqNode> parse_seq_block();
 
 public:
     Parser(const std::vector<Token> &tokens);
     std::unique_ptr<ProgramNode> parse();
+    // Erros de sintaxe encontrados por parse() ("linha N: ..."); a árvore só vale se estiver vazio
+    const std::vector<std::string> &errors() const { return parseErrors; }
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,32 @@
+#ifndef REMOTE_CHANNEL_H
+#define REMOTE_CHANNEL_H
+
+#include "runtime_value.h"
+#include <cstddef>
+#include <vector>
+
+// Ponta local de um canal cujo outro lado roda em outro processo (modo --processes). O transporte
+// (memória compartilhada, socket) serializa as mensagens com encode_message; o contrato de posse é o de
+// SpscRing/MpmcQueue: os valores passam ao canal no push e a quem recebe no pop.
+class RemoteChannel
+{
+public:
+    virtual ~RemoteChannel() = default;
+
+    virtual bool tryPush(Value *msg, size_t len) = 0;
+    virtual bool tryPop(std::vector<Value> &msg) = 0;
+    virtual bool empty() const = 0;
+    virtual bool full() const = 0;
+    // Nenhum processo pode mais escrever para esta ponta / ler o que ela envia
+    virtual bool writersGone() const = 0;
+    virtual bool readerGone() const = 0;
+    // Transportes com escrita em lote: tenta enviar o acumulado sem bloquear
+    virtual void flush() {}
+    // Fim do processo: para de receber (o que ainda faltar enviar é entregue na destruição)
+    virtual void finish() {}
+    virtual size_t oversized() const { return 0; } // mensagens descartadas por não caberem no transporte
+    virtual size_t depth() const { return 0; }     // mensagens em trânsito visíveis a este processo
+    virtual const char *transport() const = 0;
+};
+
+#endif
@@ -0,0 +1,86 @@
+#ifndef RUNTIME_VALUE_H
+#define RUNTIME_VALUE_H
+
+#include <atomic>
+#include <string>
+#include <vector>
+#include <ostream>
+
+struct ArrayObj;
+
+// Valor do runtime: união etiquetada de 16 bytes (tag + payload de 8 bytes).
+// Strings são handles para texto internado (imutável, endereço estável); arrays são handles para ArrayObj.
+struct Value
+{
+    enum Tag : unsigned char
+    {
+        NONE,
+        INT,
+        FLOAT,
+        STR,
+        ARRAY
+    };
+    Tag tag = NONE;
+    union
+    {
+        int i;
+        double f;
+        const std::string *s;
+        ArrayObj *a;
+    };
+
+    Value() : f(0.0) {}
+    static Value ofInt(int v)
+    {
+        Value r;
+        r.tag = INT;
+        r.i = v;
+        return r;
+    }
+    static Value ofFloat(double v)
+    {
+        Value r;
+        r.tag = FLOAT;
+        r.f = v;
+        return r;
+    }
+    static Value ofStr(const std::string *v)
+    {
+        Value r;
+        r.tag = STR;
+        r.s = v;
+        return r;
+    }
+    static Value ofArray(ArrayObj *v)
+    {
+        Value r;
+        r.tag = ARRAY;
+        r.a = v;
+        return r;
+    }
+    // Valor numérico (strings, arrays e indefinidos valem 0)
+    double number() const { return tag == INT ? (double)i : (tag == FLOAT ? f : 0.0); }
+};
+
+// Array heterogêneo: cada elemento é um Value (subarrays aninhados são handles).
+// O armazenamento é compartilhado por contagem de referências (atômica, para circular entre threads);
+// quem vai escrever chama unshare_array, que duplica o array apenas se ele estiver compartilhado.
+struct ArrayObj
+{
+    std::atomic<int> refs{1};
+    std::vector<Value> elems;
+};
+
+// Interna texto num pool global e devolve handle estável (seguro entre threads)
+const std::string *intern_string(const std::string &text);
+
+// Cópia em O(1) (arrays ganham uma referência) e liberação (o último dono destrói o array)
+Value copy_value(const Value &v);
+void release_value(Value &v);
+// Garante que o array de v tem v como único dono antes de uma escrita (copy-on-write)
+ArrayObj *unshare_array(Value &v);
+
+// Impressão no formato do interpretador: arrays como [a, b, [c]], floats inteiros sem casas decimais
+void print_value(std::ostream &out, const Value &v);
+
+#endif
@@ -0,0 +1,92 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+// Estado devolvido por uma fatia de tarefa leve
+enum class TaskStatus
+{
+    DONE,
+    YIELD,   // ainda tem trabalho: volta para a fila
+    BLOCKED, // estaciona em waitKey() até notify() ou até o escalonador detectar impasse
+    POLL     // espera algo que não notifica (outro processo): tentada de novo quando não houver outra tarefa
+};
+
+// Tarefa leve (green thread): executada em fatias por qualquer worker, sem pilha de SO própria
+class GreenTask
+{
+public:
+    virtual ~GreenTask() = default;
+    virtual TaskStatus step() = 0;
+    // Chave em que a tarefa espera quando step() devolve BLOCKED
+    virtual const void *waitKey() const = 0;
+    // Espera em várias chaves (select): a primeira notify de qualquer delas acorda a tarefa.
+    // nullptr ou vazio = só waitKey()
+    virtual const std::vector<const void *> *waitKeys() const { return nullptr; }
+    // Condição de espera já satisfeita? (reconferida sob o lock antes de estacionar)
+    virtual bool ready() const = 0;
+    // Impasse (todas as demais tarefas terminadas ou estacionadas): a espera deve seguir sem condição
+    virtual void release() = 0;
+};
+
+// Escalonador M:N: as tarefas de um bloco PAR são multiplexadas sobre os workers do ThreadPool compartilhado.
+// Cada worker tem um deque próprio (pop no fim, roubo no início); tarefas novas ficam numa fila de injeção
+// e só começam quando não há tarefa em andamento para continuar ou roubar, o que limita quantas tarefas
+// têm estado vivo ao mesmo tempo.
+class Scheduler
+{
+public:
+    // workers = 0 usa o tamanho do ThreadPool compartilhado
+    explicit Scheduler(size_t workers = 0);
+
+    // Executa todas as tarefas e retorna quando todas terminarem (join do bloco)
+    void runAll(const std::vector<GreenTask *> &tasks);
+    // Acorda as tarefas estacionadas em key (chamado por quem tornou a condição verdadeira)
+    void notify(const void *key);
+
+    size_t workerCount() const { return deques.size(); }
+    size_t peakLive() const { return peakStarted; } // máximo de tarefas iniciadas e ainda não concluídas
+
+private:
+    struct WorkDeque
+    {
+        std::mutex mtx;
+        std::deque<GreenTask *> items;
+        unsigned sincePoll = 0; // tomadas desde a última sondagem (só o dono do deque usa)
+    };
+
+
+    void workerLoop(size_t me);
+    GreenTask *take(size_t me);
+    GreenTask *takePolling(); // sem mtx
+    void enqueue(size_t me, GreenTask *task, bool front); // sem mtx
+    void push(size_t me, GreenTask *task, bool front);    // enqueue + acorda um worker ocioso
+    void execute(size_t me, GreenTask *task);
+    void breakDeadlock(size_t me); // requer mtx
+    void park(GreenTask *task);    // requer mtx
+
+    std::vector<std::unique_ptr<WorkDeque>> deques;
+
+    std::mutex mtx; // injeção, estacionamento e espera ociosa
+    std::condition_variable idle;
+    std::deque<GreenTask *> injection;
+    std::deque<GreenTask *> polling; // tarefas POLL; contam em queued (não há impasse enquanto sondam)
+    std::atomic<size_t> pollingCount{0};
+    std::unordered_map<const void *, std::vector<GreenTask *>> parked;
+    // Tarefas estacionadas em várias chaves: acordada por uma, sai das listas das demais
+    std::unordered_map<GreenTask *, std::vector<const void *>> multiParked;
+    size_t parkedCount = 0;
+    size_t remaining = 0;
+    size_t started = 0, peakStarted = 0; // tarefas saem da injeção uma única vez, ao iniciar
+    std::atomic<size_t> queued{0}; // tarefas em deques ou na injeção
+    std::atomic<size_t> active{0}; // tarefas em execução num worker
+};
+
+#endif
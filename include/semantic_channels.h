@@ -3,6 +3,7 @@
 
 #include "ast_nodes.h"
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 #include <string>
 #include <ostream>
@@ -15,6 +16,40 @@ struct ChannelArityInfo
     std::vector<std::string> recvComponents;
 };
 
+// Topologia de um canal em execução: quantos ramos SEQ de um mesmo PAR enviam (produtores) e recebem
+// (consumidores). LOCAL = canal de um único ramo SEQ (ou fora de PAR), que dispensa sincronização.
+enum class ChannelTopology
+{
+    LOCAL,
+    SPSC,
+    MPSC,
+    SPMC,
+    MPMC
+};
+
+struct ChannelTopologyInfo
+{
+    ChannelTopology topology = ChannelTopology::LOCAL;
+    int producers = 0;     // maior número de ramos concorrentes que enviam (uso em função conta como vários)
+    int consumers = 0;     // idem para receive
+    bool singleSeq = true; // todo uso está num único ramo SEQ (ou no programa sequencial)
+};
+
+// Coleta, por canal, as aridades e componentes de cada send/receive da AST (programa ou subárvore).
+std::unordered_map<std::string, ChannelArityInfo> collect_channel_arities(ASTNode *root);
+// Aridade de mensagem por canal (maior aridade vista), usada para dimensionar as filas do runtime.
+std::unordered_map<std::string, int> channel_message_arities(ProgramNode *program);
+// Capacidade declarada em `c_channel nome compA compB N` (somente canais com limite)
+std::unordered_map<std::string, int> channel_capacities(ProgramNode *program);
+// Classifica cada canal pela topologia de uso nos blocos PAR; o runtime escolhe a fila mais barata segura.
+std::unordered_map<std::string, ChannelTopologyInfo> analyze_channel_topology(ProgramNode *program);
+const char *channel_topology_name(ChannelTopology topology);
+// Canais declarados com `broadcast` (c_channel nome compA compB [N] broadcast)
+std::unordered_set<std::string> broadcast_channels(ProgramNode *program);
+// Ramos SEQ do bloco que recebem em cada canal: os assinantes de um canal de difusão no bloco
+std::unordered_map<std::string, int> channel_subscribers(ParNode *par);
+// Canal de difusão recebido dentro de função (assinantes deixariam de ser conhecidos antes do bloco)
+std::vector<std::string> broadcast_channel_errors(ProgramNode *program);
 // Analisa a AST coletando aridades de send/receive por canal e reporta inconsistências.
 void analyze_channel_arities(ProgramNode *program, std::ostream &out);
 
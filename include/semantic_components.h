@@ -0,0 +1,33 @@
+#ifndef SEMANTIC_COMPONENTS_H
+#define SEMANTIC_COMPONENTS_H
+
+#include "ast_nodes.h"
+#include <string>
+#include <vector>
+
+// Canal usado por ramos SEQ de mais de um componente (`comp`): no modo de um processo por componente
+// ele atravessa processos. Cada componente emissor escreve no próprio anel; o receptor lê todos.
+struct CrossChannel
+{
+    std::string name;
+    std::vector<std::string> senders; // componentes que enviam, em ordem de aparição
+    std::string receiver;             // único componente que recebe
+    bool hasReceiver = false;
+};
+
+struct ComponentLayout
+{
+    std::vector<std::string> components; // componentes com ramos em algum PAR, em ordem de aparição
+    std::vector<CrossChannel> channels;  // ordenados por nome
+    std::vector<std::string> errors;     // canais que o modo não consegue ligar entre processos
+};
+
+// Componente de um ramo SEQ: o dos send/receive do ramo (o parser marca cada um com o `comp` corrente).
+// Ramo sem canal ou anterior a qualquer `comp` pertence ao componente sem nome ("").
+std::string branch_component(SeqNode *seq);
+// Agrupa os ramos dos blocos PAR por componente e encontra os canais que cruzam componentes.
+// Erros: canal entre componentes recebido por mais de um componente (cada mensagem teria de ir a um só
+// processo) ou usado dentro de função (o processo que o usa só é conhecido na chamada).
+ComponentLayout analyze_components(ProgramNode *program);
+
+#endif
@@ -0,0 +1,199 @@
+#ifndef SHARED_CHANNEL_H
+#define SHARED_CHANNEL_H
+
+#include "broadcast_ring.h"
+#include "channel_metrics.h"
+#include "mpmc_queue.h"
+#include "remote_channel.h"
+#include "spsc_ring.h"
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+enum class ChannelKind
+{
+    SPSC, // um ramo envia e um ramo recebe
+    MPMC, // caso geral
+    BROADCAST, // `broadcast` com vários ramos recebendo: cada mensagem vai a todos
+    REMOTE // entre processos de componentes diferentes (modo --processes)
+};
+
+// Espera adaptativa de send/receive bloqueado: primeiro gira tentando de novo (latência mínima para pares
+// produtor/consumidor apertados), depois cede a fatia ao escalonador algumas vezes e só então estaciona a
+// tarefa (o worker sem trabalho dorme na variável de condição do escalonador, um futex no Linux).
+struct ChannelWaitPolicy
+{
+    unsigned spins = 64; // tentativas com pausa de CPU antes de ceder
+    unsigned yields = 2; // fatias cedidas antes de estacionar
+};
+
+// Custo das esperas no canal (contadores relaxados; lidos ao fim da execução)
+struct ChannelWaitStats
+{
+    std::atomic<unsigned long long> spins{0};         // tentativas em giro (CPU gasta esperando)
+    std::atomic<unsigned long long> spinHits{0};      // esperas resolvidas ainda no giro
+    std::atomic<unsigned long long> yields{0};        // fatias cedidas
+    std::atomic<unsigned long long> parks{0};         // tarefas estacionadas
+    std::atomic<unsigned long long> polls{0};         // sondagens de canal entre processos (em vez de estacionar)
+    std::atomic<unsigned long long> wakes{0};         // retomadas após aviso de outro ramo
+    std::atomic<unsigned long long> wakeLatencyNs{0}; // soma do tempo entre o aviso e a retomada
+};
+
+// Pausa curta dentro de laço de giro
+inline void cpu_relax()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
+
+// Canal compartilhado entre os ramos de um bloco PAR: fila lock-free escolhida pela topologia.
+// send/receive não tomam lock; o contador de espera só serve para quem produziu ou consumiu
+// saber se há tarefa estacionada a acordar sem passar pelo lock do escalonador a cada mensagem.
+// O anel lock-free tem no máximo RING_SLOTS posições, alocadas na criação. O que não cabe nele (canal sem
+// capacidade declarada, ou capacidade maior que o anel) vai para uma fila de transbordo com lock, que
+// cresce sob demanda até a capacidade declarada (sem limite se não houver). Enquanto há transbordo, todo
+// send vai para ele e cada receive esvazia o anel antes: a ordem de cada emissor se mantém.
+class SharedChannel
+{
+public:
+    static constexpr size_t RING_SLOTS = 1024; // mensagens no anel lock-free
+
+    // capacity 0: sem limite
+    SharedChannel(ChannelKind kind, size_t arity, size_t capacity);
+    // Ponta local de um canal entre processos
+    explicit SharedChannel(std::unique_ptr<RemoteChannel> endpoint);
+    ~SharedChannel(); // libera as mensagens transbordadas não recebidas
+
+    // Posse dos valores passa para o canal no push e para quem recebe no pop.
+    // reader: assinante de quem recebe (subscribe) nos canais de difusão; ignorado nos demais
+    bool tryPush(Value *msg, size_t len)
+    {
+        if (link)
+            return link->tryPush(msg, len);
+        if (spilled.load(std::memory_order_acquire) == 0 &&
+            (spsc ? spsc->tryPush(msg, len) : mpmc ? mpmc->tryPush(msg, len) : bcast->tryPush(msg, len)))
+            return true;
+        return spillPush(msg, len);
+    }
+    bool tryPop(std::vector<Value> &msg, size_t reader = 0)
+    {
+        if (link)
+            return link->tryPop(msg);
+        if (spsc ? spsc->tryPop(msg) : mpmc ? mpmc->tryPop(msg) : bcast->tryPop(msg, reader))
+            return true;
+        return spilled.load(std::memory_order_acquire) && spillPop(msg, reader);
+    }
+    bool empty(size_t reader = 0) const
+    {
+        if (link)
+            return link->empty();
+        if (!(spsc ? spsc->empty() : mpmc ? mpmc->empty() : bcast->empty(reader)))
+            return false;
+        return !spilled.load(std::memory_order_acquire) || spillEmpty(reader);
+    }
+    bool full() const
+    {
+        if (link)
+            return link->full();
+        return (spsc ? spsc->full() : mpmc ? mpmc->full() : bcast->full()) &&
+               spilled.load(std::memory_order_acquire) >= spillLimit;
+    }
+    // Mensagens na fila (aproximado; entre processos, só as que este processo vê em trânsito)
+    size_t depth() const
+    {
+        if (link)
+            return link->depth();
+        return (spsc ? spsc->size() : mpmc ? mpmc->size() : bcast->size()) + spilled.load(std::memory_order_relaxed);
+    }
+    // Capacidade declarada (0 = sem limite ou canal entre processos)
+    size_t capacity() const { return limit; }
+    ChannelKind kind() const
+    {
+        return spsc ? ChannelKind::SPSC : mpmc ? ChannelKind::MPMC : bcast ? ChannelKind::BROADCAST : ChannelKind::REMOTE;
+    }
+
+    // Difusão: o bloco PAR define quantos ramos assinam; cada ramo pega seu índice na primeira recepção
+    bool broadcast() const { return bcast != nullptr; }
+    void beginBroadcast(size_t readers);
+    size_t subscribe() { return bcast ? bcast->subscribe() : 0; }
+    // Ramo assinante terminou (tenha recebido ou não): deixa de reter mensagens no anel e no transbordo,
+    // salvo o último a sair (ver BroadcastRing::leave)
+    void leave(size_t reader);
+    size_t subscribers() const { return bcast ? bcast->subscribers() : 0; }
+
+    // O outro lado está em outro processo, que não pode acordar tarefas daqui: quem espera sonda
+    // em vez de estacionar, até o processo do outro lado terminar (peerGone)
+    bool remote() const { return link != nullptr; }
+    bool peerGone(bool forSpace) const { return link && (forSpace ? link->readerGone() : link->writersGone()); }
+    const RemoteChannel *endpoint() const { return link.get(); }
+    // Entrega o que o transporte acumulou em lote / encerra a recepção ao fim do processo
+    void flush()
+    {
+        if (link)
+            link->flush();
+    }
+    void finish()
+    {
+        if (link)
+            link->finish();
+    }
+
+    // Quem vai estacionar registra-se antes de reconferir a fila; quem muda a fila consulta
+    // needsWake depois. As barreiras seq_cst dos dois lados garantem que um dos dois vê o outro.
+    void addWaiter();
+    void removeWaiter() { waiters.fetch_sub(1, std::memory_order_relaxed); }
+    bool needsWake() const;
+    // Marca o instante do aviso (medida de latência de despertar)
+    void markWake() { lastWakeNs.store(nowNs(), std::memory_order_relaxed); }
+    unsigned long long lastWake() const { return lastWakeNs.load(std::memory_order_relaxed); }
+    static unsigned long long nowNs();
+
+    void setWaitPolicy(const ChannelWaitPolicy &p) { waitPolicy = p; }
+    const ChannelWaitPolicy &policy() const { return waitPolicy; }
+    ChannelWaitStats &stats() { return waitStats; }
+    const ChannelWaitStats &stats() const { return waitStats; }
+    ChannelMetrics &metrics() { return channelMetrics; }
+    const ChannelMetrics &metrics() const { return channelMetrics; }
+
+private:
+    // Transbordo (fora do caminho rápido). Difusão: cada mensagem fica até todo assinante passar por ela.
+    struct Spilled
+    {
+        std::vector<Value> msg;
+        size_t left = 0; // difusão: assinantes que ainda não a receberam
+    };
+    bool spillPush(Value *msg, size_t len);
+    bool spillPop(std::vector<Value> &msg, size_t reader);
+    bool spillEmpty(size_t reader) const;
+
+    std::unique_ptr<SpscRing> spsc;
+    std::unique_ptr<MpmcQueue> mpmc;
+    std::unique_ptr<BroadcastRing> bcast;
+    std::unique_ptr<RemoteChannel> link;
+    std::atomic<int> waiters{0};
+    std::atomic<unsigned long long> lastWakeNs{0};
+    ChannelWaitPolicy waitPolicy;
+    ChannelWaitStats waitStats;
+    ChannelMetrics channelMetrics;
+    size_t width = 0;
+    size_t limit = 0;               // capacidade declarada (0 = sem limite)
+    size_t spillLimit = SIZE_MAX;   // mensagens além do anel
+    mutable std::mutex spillMutex;
+    std::deque<Spilled> spill;
+    size_t spillBase = 0;           // difusão: índice global de spill.front()
+    std::vector<size_t> spillNext;  // difusão: próximo índice global de cada assinante (SIZE_MAX: saiu)
+    size_t spillGone = 0;           // difusão: assinantes que saíram no bloco
+    std::atomic<size_t> spilled{0}; // spill.size(), lido sem lock no caminho rápido
+};
+
+// Canais compartilhados por nome; o mapa é montado antes do bloco PAR e só lido durante a execução
+using SharedChannelMap = std::unordered_map<std::string, std::unique_ptr<SharedChannel>>;
+
+#endif
@@ -0,0 +1,106 @@
+#ifndef SHM_CHANNEL_H
+#define SHM_CHANNEL_H
+
+#include "remote_channel.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+// Cabeçalho de um anel na região compartilhada. Só inteiros atômicos sem lock (válidos entre processos);
+// os dados seguem o cabeçalho como quadros [tamanho: u32][mensagem codificada] que podem dar a volta.
+struct ShmRingHeader
+{
+    alignas(64) std::atomic<uint64_t> head; // bytes consumidos (leitor)
+    std::atomic<uint64_t> received;         // mensagens consumidas
+    alignas(64) std::atomic<uint64_t> tail; // bytes publicados (escritor)
+    std::atomic<uint64_t> sent;             // mensagens publicadas
+    alignas(64) std::atomic<int> writerGone; // processo escritor terminou (marcado pelo processo pai)
+    std::atomic<int> readerGone;             // processo leitor terminou
+    uint64_t limit;                          // capacidade em mensagens (a do canal)
+};
+
+// Anel de bytes de um escritor e um leitor entre dois processos, sobre memória de ShmSegment.
+// Não guarda estado próprio: cópias da mesma vista em processos diferentes operam o mesmo anel.
+// Um processo que morre no meio de uma escrita não publica o quadro, e o outro lado segue íntegro.
+class ShmRing
+{
+public:
+    ShmRing(void *base, size_t bytes);
+
+    // Apenas o escritor; false se não há espaço ou o limite de mensagens foi atingido
+    bool tryWrite(const unsigned char *frame, size_t len);
+    // Apenas o leitor; substitui frame pelo próximo quadro; false se vazio
+    bool tryRead(std::vector<unsigned char> &frame);
+    bool empty() const { return hdr->head.load(std::memory_order_acquire) == hdr->tail.load(std::memory_order_acquire); }
+    bool full() const
+    {
+        return hdr->sent.load(std::memory_order_acquire) - hdr->received.load(std::memory_order_acquire) >= hdr->limit;
+    }
+    ShmRingHeader &header() const { return *hdr; }
+    size_t dataBytes() const { return size; }
+
+private:
+    void copyIn(uint64_t pos, const unsigned char *src, size_t len);
+    void copyOut(uint64_t pos, unsigned char *dst, size_t len) const;
+
+    ShmRingHeader *hdr;
+    unsigned char *data;
+    size_t size;
+};
+
+// Região anônima compartilhada (mmap MAP_SHARED) com `rings` anéis de `ringBytes` bytes de dados cada.
+// Criada pelo processo pai antes do fork: os filhos herdam o mesmo mapeamento. As páginas só ocupam
+// memória quando tocadas, então anéis grandes custam apenas espaço de endereçamento.
+class ShmSegment
+{
+public:
+    ShmSegment(size_t rings, size_t ringBytes);
+    ShmSegment(const ShmSegment &) = delete;
+    ShmSegment &operator=(const ShmSegment &) = delete;
+    ~ShmSegment();
+
+    bool valid() const { return base != nullptr; }
+    size_t ringCount() const { return count; }
+    ShmRing ring(size_t k) const;
+
+private:
+    unsigned char *base = nullptr;
+    size_t count;
+    size_t stride; // cabeçalho + dados, múltiplo de 64
+    size_t bytes;
+    size_t mapped = 0;
+};
+
+// Ponta de um canal entre componentes vista por um processo: um anel de entrada por componente emissor
+// (lidos em rodízio) e o anel de saída deste componente. Cada anel tem um único processo de cada lado;
+// ramos do mesmo processo se revezam num lock local, que não atravessa o fork nem prende outro processo.
+class ShmChannel : public RemoteChannel
+{
+public:
+    ShmChannel(size_t arity, std::vector<ShmRing> inbound, std::vector<ShmRing> outbound);
+
+    // Valores além da aridade são descartados
+    bool tryPush(Value *msg, size_t len) override;
+    bool tryPop(std::vector<Value> &msg) override;
+    bool empty() const override;
+    bool full() const override;
+    bool writersGone() const override;
+    bool readerGone() const override;
+    size_t arity() const { return width; }
+    size_t oversized() const override { return dropped; } // mensagens maiores que o anel
+    size_t depth() const override;
+    const char *transport() const override { return "SHM"; }
+
+private:
+    size_t width;
+    std::vector<ShmRing> in;
+    std::vector<ShmRing> out; // vazio se este componente não envia; um anel caso contrário
+    std::mutex sendLock, recvLock;
+    std::vector<unsigned char> sendBuf, recvBuf;
+    size_t turn = 0;
+    size_t dropped = 0;
+};
+
+#endif
@@ -0,0 +1,69 @@
+#ifndef SOCKET_CHANNEL_H
+#define SOCKET_CHANNEL_H
+
+#include "remote_channel.h"
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Ponta de um canal entre componentes sobre sockets Unix (SOCK_STREAM), alternativa à memória
+// compartilhada quando os componentes são serviços independentes. Quadros como no anel compartilhado:
+// [tamanho: u32 LE][encode_message]. O receptor escuta num caminho e aceita uma conexão por processo
+// emissor; o emissor acumula quadros e só chama send quando o lote passa de BATCH_BYTES ou no flush
+// (fim de fatia do interpretador), amortizando a chamada de sistema por mensagem.
+// Fim dos processos do outro lado vem das marcas do processo pai (as mesmas do anel compartilhado) e,
+// para o emissor, também de EPIPE/ECONNRESET.
+class SocketChannel : public RemoteChannel
+{
+public:
+    static const size_t BATCH_BYTES = 16 * 1024;   // lote que dispara send
+    static const size_t MAX_PENDING = 256 * 1024; // acumulado que o socket não aceitou: canal cheio
+
+    // listenFd >= 0: este processo recebe (socket de escuta herdado do pai, não bloqueante).
+    // peerPath não vazio: este processo envia e conecta já na criação (o receptor aceita quando puder).
+    // writerGone: marca de cada processo emissor; readerGone: marca do processo receptor (pode ser nula).
+    SocketChannel(size_t arity, int listenFd, const std::string &peerPath,
+                  std::vector<const std::atomic<int> *> writerGone, const std::atomic<int> *readerGone);
+    SocketChannel(const SocketChannel &) = delete;
+    SocketChannel &operator=(const SocketChannel &) = delete;
+    ~SocketChannel(); // entrega o lote restante (espera o receptor ler ou sumir)
+
+    bool tryPush(Value *msg, size_t len) override;
+    bool tryPop(std::vector<Value> &msg) override;
+    bool empty() const override;
+    bool full() const override;
+    bool writersGone() const override;
+    bool readerGone() const override;
+    void flush() override;
+    void finish() override;
+    const char *transport() const override { return "SOCKET"; }
+    bool connected() const { return outFd >= 0; }
+
+private:
+    struct Inbound
+    {
+        int fd;
+        std::vector<unsigned char> buf;
+        size_t at = 0; // início do próximo quadro em buf
+    };
+
+    bool sendPending(); // sem bloquear; false se o receptor sumiu
+    bool frameReady(const Inbound &conn) const;
+    bool popBuffered(std::vector<Value> &msg); // próximo quadro já lido, sem chamada de sistema
+
+    size_t width;
+    int listenFd;
+    int outFd = -1;
+    std::vector<Inbound> in;
+    std::vector<unsigned char> batch; // quadros ainda não aceitos pelo socket, a partir de sentAt
+    size_t sentAt = 0;
+    bool broken = false;
+    std::vector<const std::atomic<int> *> writerFlags;
+    const std::atomic<int> *readerFlag;
+    std::mutex sendLock, recvLock;
+    size_t turn = 0;
+};
+
+#endif
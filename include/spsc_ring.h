@@ -0,0 +1,47 @@
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include "runtime_value.h"
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+// Fila lock-free de um produtor e um consumidor (canal entre exatamente dois componentes).
+// Posições de largura fixa como em MessageRing: [tamanho, v0 .. v(aridade-1)]. O buffer é arredondado
+// para potência de dois, mas a fila enche exatamente na capacidade pedida; cada lado guarda uma cópia
+// do índice do outro e só relê o atômico quando a cópia indica fila cheia/vazia, evitando tráfego de
+// cache a cada mensagem.
+class SpscRing
+{
+public:
+    SpscRing(size_t arity, size_t capacity);
+    SpscRing(const SpscRing &) = delete;
+    SpscRing &operator=(const SpscRing &) = delete;
+    ~SpscRing(); // libera as mensagens não recebidas
+
+    // Apenas a thread produtora. Assume a posse dos valores; false (posse mantida) se cheia.
+    // Valores além da aridade são descartados.
+    bool tryPush(Value *msg, size_t len);
+    // Apenas a thread consumidora; move a mensagem para msg; false se vazia
+    bool tryPop(std::vector<Value> &msg);
+    // Consultas aproximadas, válidas de qualquer thread
+    bool empty() const { return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire); }
+    bool full() const { return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire) >= limit; }
+    size_t size() const { return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire); }
+    size_t arity() const { return width; }
+    size_t capacity() const { return limit; }
+
+private:
+    Value *slot(size_t pos) { return buf.data() + (pos & mask) * (width + 1); }
+
+    std::vector<Value> buf;
+    size_t width;
+    size_t mask;
+    size_t limit; // mensagens
+    alignas(64) std::atomic<size_t> head{0}; // próxima leitura (consumidor)
+    size_t cachedTail = 0;                   // cópia de tail do consumidor
+    alignas(64) std::atomic<size_t> tail{0}; // próxima escrita (produtor)
+    size_t cachedHead = 0;                   // cópia de head do produtor
+};
+
+#endif
@@ -12,6 +12,7 @@ struct TACInstruction
     std::string op;
     std::string arg1;
     std::string arg2;
+    std::vector<std::string> args; // send_msg: valores enviados; recv_msg/take_msg: variáveis; select_msg: canais
 
     TACInstruction(const std::string &res, const std::string &operation,
                    const std::string &a1 = "", const std::string &a2 = "")
@@ -39,6 +40,7 @@ public:
     std::vector<TACInstruction> generate(ProgramNode *program);
     void print_tac();
     void print_tac(std::ostream &out);
+    static void print(const std::vector<TACInstruction> &code, std::ostream &out); // TAC já otimizado
     std::vector<TACInstruction> generate_from_seq(SeqNode *seq); // novo
 };
 
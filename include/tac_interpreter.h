@@ -2,61 +2,266 @@
 #define TAC_INTERPRETER_H
 
 #include "tac_generator.h"
+#include "runtime_value.h"
+#include "frame_arena.h"
+#include "message_ring.h"
+#include "shared_channel.h"
+#include <functional>
 #include <vector>
 #include <string>
 #include <unordered_map>
 #include <ostream>
 
-// Estrutura simples para simular canais: cada canal mantém fila de mensagens (vetor de vetores de ints)
+// Opcodes do TAC pré-decodificado: a string de operação é resolvida uma única vez na carga
+enum class TACOp : unsigned char
+{
+    ASSIGN,
+    ADD,
+    SUB,
+    MUL,
+    DIV,
+    EQ,
+    NE,
+    LT,
+    LE,
+    GT,
+    GE,
+    AND,
+    OR,
+    NOT,
+    PRINT,
+    PRINT_LAST,
+    LABEL,
+    IF_FALSE,
+    GOTO,
+    PARAM,
+    ARRAY_CONCAT,
+    CALL,
+    RETURN,
+    SEND_MSG,
+    RECV_MSG,
+    SELECT_MSG, // result = índice do primeiro canal com mensagem (args = canais); mensagem fica pendente
+    TAKE_MSG,   // liga a mensagem pendente do select_msg às variáveis (args)
+    ARRAY_INIT,
+    ARRAY_SET,
+    ARRAY_GET,
+    ARRAY_APPEND, // interno: `t = x + y; x = t` ou `x = x + y` fundido na carga (sem string correspondente no TAC)
+    NOP,          // operações sem efeito no interpretador (ex.: input)
+    COUNT
+};
+
+// Converte a string de operação do TAC no opcode correspondente (NOP se desconhecida)
+TACOp decode_tac_op(const std::string &op);
+
+// Estrutura simples para simular canais: cada canal mantém fila de mensagens de ints em buffer circular
 struct ChannelRuntime
 {
-    std::vector<std::vector<int>> messages; // FIFO
+    explicit ChannelRuntime(MessageRing ring) : messages(std::move(ring)) {}
+
+    MessageRing messages;   // FIFO
+    ChannelMetrics metrics; // preenchidas só com setChannelMetrics(true)
+};
+
+// Resultado de uma fatia de execução retomável
+enum class RunStatus
+{
+    DONE,   // programa terminou
+    YIELD,  // fatia de instruções esgotada; pode continuar
+    BLOCKED, // receive em canal compartilhado vazio ou send nele cheio (modo bloqueante)
+    POLL     // idem em canal entre processos: ninguém avisa, a espera é sondada de tempos em tempos
 };
 
 class TACInterpreter
 {
 public:
+    TACInterpreter() = default;
+    TACInterpreter(const TACInterpreter &) = delete;
+    TACInterpreter &operator=(const TACInterpreter &) = delete;
+    ~TACInterpreter();
+
     // Executa TAC, imprime efeitos (prints) no stream e retorna ambiente final de variáveis
     std::unordered_map<std::string, int> interpret(const std::vector<TACInstruction> &instrs, std::ostream &out);
+    // Execução retomável (tarefas do escalonador de PAR): start carrega o programa (que deve continuar vivo)
+    // e run executa até terminar, esgotar a fatia (verificada em saltos e chamadas) ou bloquear num receive.
+    void start(const std::vector<TACInstruction> &instrs);
+    RunStatus run(std::ostream &out, unsigned long long slice = 0); // slice 0 = sem limite
+    std::unordered_map<std::string, int> environment() const;
+    // Com receive bloqueante, receive em canal compartilhado vazio (ou send nele cheio) devolve BLOCKED
+    // e é reexecutado na retomada
+    void setBlockingReceive(bool on) { blockingReceive = on; }
+    const void *blockedOn() const { return waitingOn; } // canal aguardado (chave de estacionamento)
+    const std::vector<const void *> &blockedOnAll() const { return waitingKeys; } // select: todos os canais
+    bool canResume() const;
+    // Impasse: o receive pendente segue sem mensagem; o send pendente encerra o ramo com erro (error())
+    void releaseReceive() { receiveReleased = true; }
+    // Erro de execução que encerrou o programa na última execução (vazio se nenhum): send em canal cheio
+    // que nunca terá vaga (sem receptor concorrente, impasse ou receptor encerrado)
+    const std::string &error() const { return runtimeError; }
+    // Fim do ramo: sai dos canais de difusão em que o ramo conta como assinante (channel_subscribers),
+    // assinando antes se nunca recebeu, para que o anel não fique à espera de um ramo que já terminou
+    void leaveBroadcasts(const std::vector<std::string> &names);
+    // Canais compartilhados entre ramos de PAR (lock-free); nomes ausentes do mapa usam a fila local, sem
+    // sincronização nem espera (a análise de topologia só deixa fora do mapa canais de um único ramo).
+    // Mensagens levam Values: arrays viajam como handles e, quando o emissor não usa mais o array, são
+    // movidos sem cópia nem referência extra (quem recebe escreve no mesmo buffer sem copy-on-write).
+    void setSharedChannels(const SharedChannelMap *map) { shared = map; }
+    // Chamado com o canal compartilhado quando send/receive muda uma fila que tem tarefa estacionada
+    void setChannelWake(std::function<void(const void *)> fn) { wake = std::move(fn); }
+    // Aridade de mensagem por canal (channel_message_arities) para dimensionar as filas na criação
+    void setChannelArities(const std::unordered_map<std::string, int> &arities) { channelArities = arities; }
+    // Capacidade declarada por canal (channel_capacities). Sem outro ramo para consumir, send sequencial em
+    // canal cheio é erro de execução; dentro de PAR o send bloqueia até haver vaga.
+    void setChannelCapacities(const std::unordered_map<std::string, int> &capacities) { channelCapacities = capacities; }
+    // Conta envios, recepções, profundidade e tempo bloqueado por canal (ChannelMetrics do canal
+    // compartilhado ou da fila local); desligado, send/receive não pagam nada além do teste
+    void setChannelMetrics(bool on) { meterChannels = on; }
+    const std::unordered_map<std::string, ChannelRuntime> &localChannels() const { return channels; }
+    // Quantidade de instruções executadas na última chamada de interpret()
+    unsigned long long executedInstructions() const { return executed; }
+    // Slots do ambiente global da última carga (um por nome distinto do programa: variáveis, temporários
+    // e literais)
+    size_t slotCount() const { return slotNames.size(); }
+    // Despacho por switch sobre o opcode no lugar do computed goto (o mesmo laço de antes do threading),
+    // para comparar os dois no mesmo binário (interpreter_bench); sem efeito onde só há switch
+    void setSwitchDispatch(bool on) { switchDispatch = on; }
 
 private:
-    std::unordered_map<std::string, int> env;            // variáveis e temporários
-    std::unordered_map<std::string, std::string> envStr; // valores string
-    std::unordered_map<std::string, double> envF;        // valores float
+    template <bool Threaded>
+    RunStatus execute(std::ostream &out, unsigned long long slice);
+    // Instrução pré-decodificada: opcode, slots dos operandos e destino de salto já resolvido
+    struct DecodedInstr
+    {
+        TACOp op = TACOp::NOP;
+        TACOp fused = TACOp::NOP; // array_append: operação original (+ ou array_concat)
+        bool inPlace = false;     // array_append de `x = x + y` (sem a cópia seguinte para pular)
+        int result = -1;
+        int arg1 = -1;
+        int arg2 = -1;
+        int target = -1; // ip de destino de goto/if_false/call (-1 se label inexistente)
+        int func = -1;   // call: índice em functions
+        int list = -1;   // send_msg/recv_msg/take_msg: primeiro operando em operandLists
+        int count = 0;   // send_msg/recv_msg/take_msg: quantidade de operandos
+    };
+    // Operandos locais de função são codificados como LOCAL_SLOT_BASE + deslocamento no frame corrente
+    static constexpr int LOCAL_SLOT_BASE = 1 << 30;
+    // Corpo de função (do label ao return): nomes escritos nele, exceto retval/argN, são locais do frame
+    struct FunctionInfo
+    {
+        std::vector<Value> localInit; // leitura literal de cada local (valor inicial do frame)
+    };
+    std::vector<FunctionInfo> functions;
+    std::unordered_map<std::string, int> slotOf; // nome -> slot (usado apenas na carga)
+    std::vector<std::string> slotNames;          // slot -> nome (impressão / ambiente final)
+    std::vector<DecodedInstr> code;              // TAC decodificado, paralelo ao vetor original
+    std::vector<int> operandLists;               // slots dos operandos de send_msg/recv_msg, em sequência
+    std::vector<char> moveOperand;               // paralelo a operandLists: send_msg pode mover o valor
+    std::vector<unsigned> selectTurn;            // paralelo a code: select_msg começa a procurar neste caso
+    // Cada identificador/temporário do TAC recebe um slot denso na carga; a execução só indexa o vetor.
+    std::vector<Value> slots; // valor de cada slot (NONE enquanto indefinido)
+    // Pool de constantes: leitura literal de cada token (int, float ou string crua), feita uma vez na carga.
+    // Tokens que nenhuma instrução escreve são constantes e já começam com esse valor no slot.
+    std::vector<Value> constants;
+    std::vector<bool> constantSlot;
+    const Value zero = Value::ofInt(0); // operando ausente
     std::unordered_map<std::string, ChannelRuntime> channels;
-    std::unordered_map<std::string, std::vector<std::string>> funcParams; // nome -> lista params
+    std::unordered_map<std::string, int> channelArities;
+    std::unordered_map<std::string, int> channelCapacities;
     struct CallFrame
     {
         size_t return_ip;
-        std::string return_target;
+        int return_target; // operando no frame de quem chamou
         bool has_target;
+        Value *caller_fp;
+        FrameArena::Mark mark;
+        size_t nlocals;
     };
     std::vector<CallFrame> callStack;
-    // estado para construção de mensagem em envio
-    std::string buildingChannel;
-    size_t expectedSendArgs = 0;
-    std::vector<int> buildingMessage;
-    // estado para recepção
-    std::string receivingChannel;
-    size_t expectedRecvArgs = 0;
-    std::vector<int> receivedMessage;
-    // armazenamento simples de arrays: nome -> vetor de double (suporta int/float)
-    std::unordered_map<std::string, std::vector<double>> arrays;
-    // Armazenamento paralelo para elementos string em arrays heterogêneos
-    std::unordered_map<std::string, std::vector<std::string>> arraysStr;
-    // Para arrays aninhados: guarda referências a subarrays (nome do temp de subarray ou vazio se elemento escalar)
-    std::unordered_map<std::string, std::vector<std::string>> arraysNested;
-    // Alternativa segura para matrizes: armazenamento direto 2D (cada linha é um vetor de double)
-    std::unordered_map<std::string, std::vector<std::vector<double>>> matrices;
-    // Armazenamento temporário de linhas antes de atribuição final
-    std::unordered_map<std::string, std::vector<std::vector<double>>> flattenedRows;
-    // Número de colunas por array matricial flatten
-    std::unordered_map<std::string, int> arrayCols;
-
-    double valueOf(const std::string &token) const;         // resolve nome ou literal
-    std::string strValueOf(const std::string &token) const; // resolve string
-    void finalizeSend();
-    void finalizeReceive();
+    // Frames de chamada vivem na arena: entrar/sair de função só ajusta o topo e o ponteiro de frame
+    FrameArena arena;
+    Value *fp = nullptr;
+    std::vector<Value> rootFrame; // frame de código de função executado fora de chamada
+    std::vector<Value> message; // mensagem de send_msg/recv_msg (capacidade reaproveitada)
+    bool pendingSend = false;   // send_msg pausado com a mensagem já montada (reexecução não remonta)
+    // Slots usados pela heurística de cálculo em emulateCalculator (-1 se ausentes no programa)
+    int slotOperacao = -1, slotValor1 = -1, slotValor2 = -1, slotResultado = -1;
+    unsigned long long executed = 0;
+    std::string runtimeError;
+    // estado de execução retomável
+    const std::vector<TACInstruction> *program = nullptr;
+    size_t pc = 0; // próxima instrução a executar
+    bool blockingReceive = false;
+    bool switchDispatch = false;
+    bool receiveReleased = false;
+    const void *waitingOn = nullptr;
+    SharedChannel *waitingShared = nullptr; // registrado em addWaiter até a retomada
+    std::vector<SharedChannel *> waitingSelect; // select estacionado: registrado em cada canal
+    std::vector<const void *> waitingKeys;      // chaves de estacionamento do select (os mesmos canais)
+    std::vector<SharedChannel *> unflushed;     // canais remotos com envio em lote desde a última pausa
+    std::vector<std::pair<const SharedChannel *, size_t>> subscriptions; // canal de difusão -> assinante
+    bool meterChannels = false;
+    unsigned long long blockedSince = 0; // início da espera corrente (0 = nenhuma), com métricas ligadas
+    bool waitingForSpace = false;            // send bloqueado (espera vaga) ou receive (espera mensagem)
+    unsigned long long parkedAt = 0;         // instante do estacionamento (latência de despertar)
+    unsigned waitYields = 0;                 // fatias já cedidas na espera corrente
+    const SharedChannelMap *shared = nullptr;
+    std::function<void(const void *)> wake;
+
+    int intern(const std::string &name);
+    void load(const std::vector<TACInstruction> &instrs);
+    void fuseAppends();   // reconhece `t = x + y; x = t` e `x = x + y` e troca por array_append
+    // Delimita corpos de função e recodifica seus operandos locais (instrs: TAC de origem, para `global`)
+    void loadFunctions(const std::vector<TACInstruction> &instrs);
+    void markMovableSends(); // operandos de send_msg cujo valor não é mais lido depois do envio
+    void releaseMessage();
+    // Referência ao armazenamento do operando (slot global ou posição no frame corrente)
+    Value &ref(int slot) { return slot >= LOCAL_SLOT_BASE ? fp[slot - LOCAL_SLOT_BASE] : slots[slot]; }
+    const Value &ref(int slot) const { return slot >= LOCAL_SLOT_BASE ? fp[slot - LOCAL_SLOT_BASE] : slots[slot]; }
+    bool is(int slot, Value::Tag t) const { return slot >= 0 && ref(slot).tag == t; }
+    void store(int slot, Value v); // libera o valor anterior do slot
+    void releaseSlots();
+    void unwindFrames(); // desempilha (liberando) frames deixados por execução interrompida
+    // Valor atual do operando; nome global ainda indefinido cai na sua leitura literal
+    // (locais já nascem com a leitura literal no frame)
+    const Value &operand(int slot) const
+    {
+        if (slot < 0)
+            return zero;
+        if (slot >= LOCAL_SLOT_BASE)
+            return fp[slot - LOCAL_SLOT_BASE];
+        return slots[slot].tag != Value::NONE ? slots[slot] : constants[slot];
+    }
+    Value resolve(int slot) const;  // cópia do operando (arrays compartilhados)
+    double valueOf(int slot) const; // valor numérico do operando
+    bool sendLocal(const std::string &name); // message para a fila local; false (erro) se limitada e cheia
+    ChannelRuntime &channel(const std::string &name); // fila local, criada no primeiro uso
+    SharedChannel *sharedChannel(const std::string &name) const;
+    // Assinante deste ramo num canal de difusão (assina na primeira recepção); 0 nos demais canais
+    size_t subscriber(SharedChannel *chan);
+    size_t subscribed(const SharedChannel *chan) const;
+    // Operação concluída após espera: o tempo bloqueado conta no canal (chan nulo só encerra a medida)
+    void endBlocked(SharedChannel *chan, bool forSpace);
+    // Resultado de uma operação em canal compartilhado: concluída, ceder a fatia ou estacionar
+    enum class WaitStep
+    {
+        DONE,
+        YIELD,
+        PARK,
+        POLL,  // canal entre processos
+        FAILED // send sem vaga possível: runtimeError preenchido
+    };
+    // Envia message / recebe em message pelo canal compartilhado
+    WaitStep sendShared(SharedChannel *chan, const std::string &name);
+    void flushRemote(); // fim de fatia: entrega os lotes dos canais remotos
+    WaitStep receiveShared(SharedChannel *chan);
+    // select_msg: retira a mensagem do primeiro canal pronto a partir de turn (rodízio); -1 se nenhum
+    int trySelect(const TACInstruction &ins, unsigned &turn);
+    // Nenhum canal pronto: espera adaptativa em todos os canais compartilhados do select
+    WaitStep waitSelect(const TACInstruction &ins, unsigned &turn, int &chosen);
+    void endSelectWait(); // cancela o registro de espera do select em seus canais
+    // Espera adaptativa após tentativa falha: gira, cede a fatia e por fim estaciona (ChannelWaitPolicy)
+    template <class Attempt>
+    WaitStep waitShared(SharedChannel *chan, bool forSpace, Attempt attempt);
+    void emulateCalculator(); // heurística do exemplo cliente/servidor após cada recv_msg completo
 };
 
 #endif
@@ -0,0 +1,87 @@
+#ifndef TAC_OPTIMIZER_H
+#define TAC_OPTIMIZER_H
+
+#include "tac_generator.h"
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Nível de otimização do TAC (-O0, -O1, -O2)
+enum class OptLevel
+{
+    O0, // TAC do gerador sem mudanças
+    O1, // passes locais e baratos
+    O2  // O1 mais os passes que olham o programa inteiro
+};
+
+// Reconhece "-O0", "-O1" e "-O2"; false (level intacto) para o resto
+bool parse_opt_level(const std::string &flag, OptLevel &level);
+
+// Passe TAC -> TAC: reescreve o programa no lugar, preservando o que o interpretador e o ARMGenerator
+// observam (saída, canais e o valor final das variáveis do programa)
+class TACPass
+{
+public:
+    virtual ~TACPass() = default;
+    virtual const char *name() const = 0;
+    virtual void run(std::vector<TACInstruction> &code) = 0;
+};
+
+// Classificação dos operandos de uma instrução, como o interpretador a decodifica
+bool tac_is_temp(const std::string &name); // temporário do gerador (t0, t1, ...)
+// Operandos lidos como valor, que aceitam um literal no lugar do nome (ponteiros para campos de ins).
+// Ficam de fora leituras que dependem do nome: array indexado, função, argN de param e canais.
+std::vector<std::string *> tac_value_operands(TACInstruction &ins);
+// Nomes que a instrução escreve (result ou as variáveis de recv_msg/take_msg; array_set altera result)
+std::vector<const std::string *> tac_written_names(const TACInstruction &ins);
+// Só calcula result a partir dos operandos: sem efeito além de escrever result (sem call, canais, param)
+bool tac_is_pure(const TACInstruction &ins);
+// Vezes que o nome aparece em qualquer campo da instrução
+int tac_mentions(const TACInstruction &ins, const std::string &name);
+
+// Remove o código que segue um goto até o próximo label (nenhum salto chega lá), o goto para um label
+// logo adiante e os labels que nenhum salto ou chamada referencia (menos o label de retorno de função chamada)
+std::unique_ptr<TACPass> make_unreachable_code_pass();
+// Dobra operações aritméticas, de comparação e lógicas sobre literais (mesma promoção int/float do
+// interpretador), propaga literais para os usos dentro de cada bloco e, no programa inteiro, os dos
+// temporários de definição única (que então somem); if_false com condição conhecida vira goto ou some
+std::unique_ptr<TACPass> make_constant_folding_pass();
+// Propaga cópias `t = y` para as leituras seguintes do bloco e junta `t = a op b; x = t` em `x = a op b`
+// (também `arg0 = t`), eliminando a cópia e o temporário
+std::unique_ptr<TACPass> make_copy_propagation_pass();
+// Remove definições puras de temporários que nenhuma instrução lê
+std::unique_ptr<TACPass> make_dead_temps_pass();
+
+// Medida de uma execução de passe
+struct PassStats
+{
+    std::string pass;
+    unsigned long long ns = 0;
+    size_t before = 0; // instruções na entrada
+    size_t after = 0;  // instruções na saída
+};
+
+// Lista ordenada de passes; o construtor monta a do nível pedido. Cada run acumula as medidas de cada
+// passe (um gerenciador por thread: os ramos de PAR têm cada um o seu)
+class PassManager
+{
+public:
+    explicit PassManager(OptLevel level);
+
+    void add(std::unique_ptr<TACPass> pass) { passes.push_back(std::move(pass)); }
+    void run(std::vector<TACInstruction> &code);
+    OptLevel level() const { return optLevel; }
+    size_t passCount() const { return passes.size(); }
+    const std::vector<PassStats> &stats() const { return history; }
+
+private:
+    OptLevel optLevel;
+    std::vector<std::unique_ptr<TACPass>> passes;
+    std::vector<PassStats> history;
+};
+
+// Uma linha por passe executado: nome, tempo e instruções removidas; por fim o total
+void print_pass_stats(const std::vector<PassStats> &stats, std::ostream &out);
+
+#endif
@@ -0,0 +1,43 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Pool persistente de threads para os ramos SEQ de um bloco PAR.
+// As threads são criadas uma vez e reaproveitadas entre blocos; runAll tem semântica de join.
+class ThreadPool
+{
+public:
+    // workers = 0 usa std::thread::hardware_concurrency() (mínimo 1)
+    explicit ThreadPool(size_t workers = 0);
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+    ~ThreadPool();
+
+    // Executa as tarefas em paralelo e só retorna quando todas terminarem.
+    // A thread chamadora também consome tarefas enquanto espera; a primeira exceção é relançada após o join.
+    void runAll(std::vector<std::function<void()>> &tasks);
+    size_t size() const { return workers.size(); }
+
+    // Pool compartilhado do processo, criado no primeiro uso
+    static ThreadPool &shared();
+
+private:
+    void workerLoop();
+    bool runOne(std::unique_lock<std::mutex> &lock); // executa uma tarefa da fila, se houver
+
+    std::vector<std::thread> workers;
+    std::mutex mtx;
+    std::condition_variable wake; // nova tarefa ou encerramento
+    std::condition_variable done; // alguma tarefa terminou
+    std::deque<std::function<void()>> queue;
+    bool stopping = false;
+};
+
+#endif
@@ -86,6 +86,11 @@ vector<string> ARMGenerator::generate(const vector<TACInstruction>& tac) {
 }
 
 string ARMGenerator::get_register(const string& var) {
+    // Literal no operando (TAC otimizado): carregado no registrador de rascunho r7
+    if (!var.empty() && (isdigit(var[0]) || (var[0] == '-' && var.size() > 1 && isdigit(var[1])))) {
+        arm_code.push_back("mov r7, #" + var);
+        return "r7";
+    }
     if (var_registers.find(var) == var_registers.end()) {
         // Estratégia simples: r0–r6
         if (register_counter < 7) {
@@ -0,0 +1,296 @@
+#include "tac_optimizer.h"
+#include "tac_interpreter.h"
+#include <climits>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <unordered_map>
+
+namespace
+{
+    // Leitura literal do token como no interpretador (strtol inteiro, senão strtod); false se não for número
+    bool numeric_literal(const std::string &token, Value &v)
+    {
+        if (token.empty())
+            return false;
+        char *end = nullptr;
+        long i = std::strtol(token.c_str(), &end, 10);
+        if (*end == '\0')
+        {
+            v = Value::ofInt((int)i);
+            return true;
+        }
+        double f = std::strtod(token.c_str(), &end);
+        if (*end == '\0')
+        {
+            v = Value::ofFloat(f);
+            return true;
+        }
+        return false;
+    }
+
+    // Token cuja leitura literal devolve exatamente v (float sempre com ponto, senão seria lido como int)
+    bool format_literal(const Value &v, std::string &token)
+    {
+        if (v.tag == Value::INT)
+        {
+            token = std::to_string(v.i);
+            return true;
+        }
+        if (!std::isfinite(v.f))
+            return false;
+        char buf[40];
+        std::snprintf(buf, sizeof buf, "%.17g", v.f);
+        token = buf;
+        if (token.find_first_of(".e") == std::string::npos)
+            token += ".0";
+        Value back;
+        return numeric_literal(token, back) && back.tag == Value::FLOAT && back.f == v.f;
+    }
+
+    // Conversão (int) do interpretador, só quando definida
+    bool to_int(const Value &v, int &out)
+    {
+        double d = v.number();
+        if (!(d > (double)INT_MIN - 1.0 && d < (double)INT_MAX + 1.0))
+            return false;
+        out = (int)d;
+        return true;
+    }
+
+    // Avalia `lhs op rhs` (rhs ignorado em !) com a semântica do interpretador; false se não for dobrável
+    bool evaluate(TACOp op, const Value &lhs, const Value &rhs, Value &result)
+    {
+        switch (op)
+        {
+        case TACOp::ADD:
+        case TACOp::SUB:
+        case TACOp::MUL:
+        case TACOp::DIV:
+            if (lhs.tag == Value::FLOAT || rhs.tag == Value::FLOAT)
+            {
+                double l = lhs.number(), r = rhs.number(), v;
+                if (op == TACOp::ADD)
+                    v = l + r;
+                else if (op == TACOp::SUB)
+                    v = l - r;
+                else if (op == TACOp::MUL)
+                    v = l * r;
+                else
+                    v = r != 0.0 ? l / r : 0.0;
+                result = Value::ofFloat(v);
+                return true;
+            }
+            else
+            {
+                // Aritmética int com o estouro em complemento de dois da máquina
+                long long l = lhs.i, r = rhs.i, v;
+                if (op == TACOp::ADD)
+                    v = l + r;
+                else if (op == TACOp::SUB)
+                    v = l - r;
+                else if (op == TACOp::MUL)
+                    v = (long long)(unsigned)((unsigned)l * (unsigned)r);
+                else if (r == 0)
+                    v = 0;
+                else if (l == INT_MIN && r == -1)
+                    return false; // trap na execução; fica para o interpretador
+                else
+                    v = l / r;
+                result = Value::ofInt((int)(unsigned)(unsigned long long)v);
+                return true;
+            }
+        case TACOp::EQ:
+        case TACOp::NE:
+        case TACOp::LT:
+        case TACOp::LE:
+        case TACOp::GT:
+        case TACOp::GE:
+        case TACOp::AND:
+        case TACOp::OR:
+        case TACOp::NOT:
+        {
+            // Comparações e lógicos truncam os operandos para int
+            int l = 0, r = 0;
+            if (!to_int(lhs, l) || (op != TACOp::NOT && !to_int(rhs, r)))
+                return false;
+            int v;
+            switch (op)
+            {
+            case TACOp::EQ:
+                v = l == r;
+                break;
+            case TACOp::NE:
+                v = l != r;
+                break;
+            case TACOp::LT:
+                v = l < r;
+                break;
+            case TACOp::LE:
+                v = l <= r;
+                break;
+            case TACOp::GT:
+                v = l > r;
+                break;
+            case TACOp::GE:
+                v = l >= r;
+                break;
+            case TACOp::AND:
+                v = l && r;
+                break;
+            case TACOp::OR:
+                v = l || r;
+                break;
+            default:
+                v = !l;
+                break;
+            }
+            result = Value::ofInt(v);
+            return true;
+        }
+        default:
+            return false;
+        }
+    }
+
+    class ConstantFoldingPass : public TACPass
+    {
+    public:
+        const char *name() const override { return "constant-folding"; }
+
+        void run(std::vector<TACInstruction> &code) override
+        {
+            // Cada dobra pode expor outra (literal propagado para uma conta que então dobra): até estabilizar
+            bool changed = true;
+            while (changed)
+            {
+                changed = foldBlocks(code);
+                changed = propagateTemps(code) || changed;
+            }
+        }
+
+    private:
+        // Dobra a instrução se os operandos já são literais; false se nada mudou. Instrução que deixa de
+        // existir (if_false sempre falso) vira op vazia, removida pelo chamador.
+        static bool fold(TACInstruction &ins)
+        {
+            TACOp op = decode_tac_op(ins.op);
+            Value lhs, rhs, result;
+            if (op == TACOp::IF_FALSE)
+            {
+                if (!numeric_literal(ins.arg1, lhs))
+                    return false;
+                // Condição falsa sempre salta; verdadeira nunca
+                if (lhs.number() == 0.0)
+                    ins = TACInstruction("", "goto", ins.arg2);
+                else
+                    ins.op.clear();
+                return true;
+            }
+            if (!numeric_literal(ins.arg1, lhs) || (op != TACOp::NOT && !numeric_literal(ins.arg2, rhs)))
+                return false;
+            std::string token;
+            if (!evaluate(op, lhs, rhs, result) || !format_literal(result, token))
+                return false;
+            ins = TACInstruction(ins.result, "=", token);
+            return true;
+        }
+
+        // Propagação dentro de cada bloco básico: depois de `x = literal`, leituras de x até a próxima escrita
+        // de x usam o literal. Labels (junção de fluxos) e chamadas esquecem tudo, assim como recv_msg e
+        // take_msg (a heurística da calculadora do interpretador escreve em `resultado`).
+        static bool foldBlocks(std::vector<TACInstruction> &code)
+        {
+            bool changed = false;
+            std::unordered_map<std::string, std::string> known;
+            std::vector<TACInstruction> kept;
+            kept.reserve(code.size());
+            for (auto &ins : code)
+            {
+                TACOp op = decode_tac_op(ins.op);
+                if (op == TACOp::LABEL)
+                    known.clear();
+                for (std::string *operand : tac_value_operands(ins))
+                {
+                    auto it = known.find(*operand);
+                    if (it != known.end())
+                    {
+                        *operand = it->second;
+                        changed = true;
+                    }
+                }
+                if (fold(ins))
+                {
+                    changed = true;
+                    if (ins.op.empty())
+                        continue;
+                    op = decode_tac_op(ins.op);
+                }
+                for (const std::string *name : tac_written_names(ins))
+                    known.erase(*name);
+                Value v;
+                if (op == TACOp::ASSIGN && numeric_literal(ins.arg1, v))
+                    known[ins.result] = ins.arg1;
+                else if (op == TACOp::CALL || op == TACOp::RECV_MSG || op == TACOp::TAKE_MSG || op == TACOp::GOTO)
+                    known.clear();
+                kept.push_back(std::move(ins));
+            }
+            code.swap(kept);
+            return changed;
+        }
+
+        // Temporário com uma única definição `t = literal` vale o literal em todo o programa: o gerador sempre
+        // define o temporário antes de lê-lo. Leituras trocadas pelo literal; sem leitura restante, a
+        // definição some.
+        static bool propagateTemps(std::vector<TACInstruction> &code)
+        {
+            std::unordered_map<std::string, int> defs;
+            std::unordered_map<std::string, std::string> value;
+            for (const auto &ins : code)
+                for (const std::string *name : tac_written_names(ins))
+                    if (tac_is_temp(*name))
+                        ++defs[*name];
+            Value v;
+            for (const auto &ins : code)
+                if (ins.op == "=" && defs[ins.result] == 1 && numeric_literal(ins.arg1, v))
+                    value[ins.result] = ins.arg1;
+            if (value.empty())
+                return false;
+            bool changed = false;
+            // Leituras que não aceitam literal (array base, param, ...) mantêm a definição viva
+            std::unordered_map<std::string, bool> pinned;
+            for (auto &ins : code)
+            {
+                for (std::string *operand : tac_value_operands(ins))
+                {
+                    auto it = value.find(*operand);
+                    if (it != value.end())
+                    {
+                        *operand = it->second;
+                        changed = true;
+                    }
+                }
+                bool defines = ins.op == "=" && value.count(ins.result);
+                for (const std::string *field : {&ins.result, &ins.arg1, &ins.arg2})
+                    if (value.count(*field) && !(defines && field == &ins.result))
+                        pinned[*field] = true;
+                for (const auto &a : ins.args)
+                    if (value.count(a))
+                        pinned[a] = true;
+            }
+            std::vector<TACInstruction> kept;
+            kept.reserve(code.size());
+            for (auto &ins : code)
+                if (!(ins.op == "=" && value.count(ins.result) && !pinned.count(ins.result)))
+                    kept.push_back(std::move(ins));
+            changed = changed || kept.size() != code.size();
+            code.swap(kept);
+            return changed;
+        }
+    };
+}
+
+std::unique_ptr<TACPass> make_constant_folding_pass()
+{
+    return std::unique_ptr<TACPass>(new ConstantFoldingPass());
+}
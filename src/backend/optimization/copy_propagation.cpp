@@ -0,0 +1,133 @@
+#include "tac_optimizer.h"
+#include "tac_interpreter.h"
+#include <iterator>
+#include <unordered_map>
+
+namespace
+{
+    // Fim de bloco ou instrução que pode escrever nomes fora de result (corpo de função, calculadora do
+    // interpretador depois de recv_msg/take_msg)
+    bool is_barrier(TACOp op)
+    {
+        switch (op)
+        {
+        case TACOp::LABEL:
+        case TACOp::GOTO:
+        case TACOp::IF_FALSE:
+        case TACOp::CALL:
+        case TACOp::RETURN:
+        case TACOp::RECV_MSG:
+        case TACOp::TAKE_MSG:
+        case TACOp::SELECT_MSG:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    class CopyPropagationPass : public TACPass
+    {
+    public:
+        const char *name() const override { return "copy-propagation"; }
+
+        void run(std::vector<TACInstruction> &code) override
+        {
+            // Uma junção pode expor outra cópia (cadeias t1 = ...; t2 = t1; x = t2): até estabilizar
+            bool changed = true;
+            while (changed)
+            {
+                changed = forwardCopies(code);
+                changed = coalesce(code) || changed;
+            }
+        }
+
+    private:
+        // Dentro de cada bloco, depois de `t = y` as leituras de t usam y enquanto nem t nem y forem
+        // reescritos. A definição de t fica; sem leituras, dead-temps a remove.
+        static bool forwardCopies(std::vector<TACInstruction> &code)
+        {
+            bool changed = false;
+            std::unordered_map<std::string, std::string> copies;
+            for (auto &ins : code)
+            {
+                TACOp op = decode_tac_op(ins.op);
+                if (op == TACOp::LABEL)
+                    copies.clear();
+                for (std::string *operand : tac_value_operands(ins))
+                {
+                    auto it = copies.find(*operand);
+                    if (it != copies.end())
+                    {
+                        *operand = it->second;
+                        changed = true;
+                    }
+                }
+                for (const std::string *name : tac_written_names(ins))
+                {
+                    copies.erase(*name);
+                    for (auto it = copies.begin(); it != copies.end();)
+                        it = it->second == *name ? copies.erase(it) : std::next(it);
+                }
+                if (op == TACOp::ASSIGN && tac_is_temp(ins.result) && !ins.arg1.empty() && ins.arg1 != ins.result)
+                    copies[ins.result] = ins.arg1;
+                else if (is_barrier(op))
+                    copies.clear();
+            }
+            return changed;
+        }
+
+        // `t = a op b; ...; x = t` com t sem outras menções: a operação escreve direto em x e a cópia some.
+        // Entre as duas não pode haver salto, label, chamada nem menção a x (x ainda vale o antigo ali).
+        static bool coalesce(std::vector<TACInstruction> &code)
+        {
+            std::unordered_map<std::string, int> mentions;
+            for (const auto &ins : code)
+                for (const std::string *field : {&ins.result, &ins.arg1, &ins.arg2})
+                    if (tac_is_temp(*field))
+                        ++mentions[*field];
+            for (const auto &ins : code)
+                for (const auto &a : ins.args)
+                    if (tac_is_temp(a))
+                        ++mentions[a];
+
+            std::vector<bool> dropped(code.size(), false);
+            bool changed = false;
+            for (size_t i = 0; i < code.size(); ++i)
+            {
+                const std::string t = code[i].result;
+                if (dropped[i] || !tac_is_pure(code[i]) || !tac_is_temp(t) || mentions[t] != 2)
+                    continue;
+                size_t j = i + 1;
+                while (j < code.size() && (dropped[j] || !tac_mentions(code[j], t)) &&
+                       !is_barrier(decode_tac_op(code[j].op)))
+                    ++j;
+                if (j == code.size() || code[j].op != "=" || code[j].arg1 != t || code[j].result.empty() ||
+                    code[j].result == t)
+                    continue;
+                const std::string &x = code[j].result;
+                bool clobbered = false;
+                for (size_t k = i + 1; k < j && !clobbered; ++k)
+                    clobbered = !dropped[k] && tac_mentions(code[k], x);
+                if (clobbered)
+                    continue;
+                code[i].result = x;
+                dropped[j] = true;
+                changed = true;
+            }
+            if (!changed)
+                return false;
+            std::vector<TACInstruction> kept;
+            kept.reserve(code.size());
+            for (size_t i = 0; i < code.size(); ++i)
+                if (!dropped[i])
+                    kept.push_back(std::move(code[i]));
+            code.swap(kept);
+            return true;
+        }
+    };
+}
+
+std::unique_ptr<TACPass> make_copy_propagation_pass()
+{
+    return std::unique_ptr<TACPass>(new CopyPropagationPass());
+}
@@ -0,0 +1,50 @@
+#include "tac_optimizer.h"
+#include <unordered_map>
+
+namespace
+{
+    class DeadTempsPass : public TACPass
+    {
+    public:
+        const char *name() const override { return "dead-temps"; }
+
+        void run(std::vector<TACInstruction> &code) override
+        {
+            // Remover uma definição pode deixar sem leitura os temporários que ela lia: até estabilizar
+            while (sweep(code))
+            {
+            }
+        }
+
+    private:
+        // Leitura é qualquer menção fora do result de uma instrução pura (array_set, call e canais contam
+        // como leitura do próprio result, por cautela)
+        static bool sweep(std::vector<TACInstruction> &code)
+        {
+            std::unordered_map<std::string, int> reads;
+            for (const auto &ins : code)
+            {
+                bool pure = tac_is_pure(ins);
+                for (const std::string *field : {&ins.result, &ins.arg1, &ins.arg2})
+                    if (tac_is_temp(*field) && !(pure && field == &ins.result))
+                        ++reads[*field];
+                for (const auto &a : ins.args)
+                    if (tac_is_temp(a))
+                        ++reads[a];
+            }
+            std::vector<TACInstruction> kept;
+            kept.reserve(code.size());
+            for (auto &ins : code)
+                if (!(tac_is_pure(ins) && tac_is_temp(ins.result) && !reads.count(ins.result)))
+                    kept.push_back(std::move(ins));
+            bool changed = kept.size() != code.size();
+            code.swap(kept);
+            return changed;
+        }
+    };
+}
+
+std::unique_ptr<TACPass> make_dead_temps_pass()
+{
+    return std::unique_ptr<TACPass>(new DeadTempsPass());
+}
@@ -0,0 +1,78 @@
+#include "tac_optimizer.h"
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+
+bool parse_opt_level(const std::string &flag, OptLevel &level)
+{
+    if (flag == "-O0")
+        level = OptLevel::O0;
+    else if (flag == "-O1")
+        level = OptLevel::O1;
+    else if (flag == "-O2")
+        level = OptLevel::O2;
+    else
+        return false;
+    return true;
+}
+
+PassManager::PassManager(OptLevel level) : optLevel(level)
+{
+    // Ordem importa: cada passe vê o TAC já simplificado pelos anteriores
+    if (level == OptLevel::O0)
+        return;
+    add(make_constant_folding_pass());
+    if (level == OptLevel::O2)
+    {
+        add(make_copy_propagation_pass());
+        add(make_dead_temps_pass()); // as cópias propagadas deixam definições sem leitura
+    }
+    add(make_unreachable_code_pass()); // recolhe os ramos de if_false com condição conhecida
+}
+
+void PassManager::run(std::vector<TACInstruction> &code)
+{
+    for (auto &pass : passes)
+    {
+        PassStats st;
+        st.pass = pass->name();
+        st.before = code.size();
+        auto begin = std::chrono::steady_clock::now();
+        pass->run(code);
+        st.ns = (unsigned long long)std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - begin)
+                    .count();
+        st.after = code.size();
+        history.push_back(st);
+    }
+}
+
+void print_pass_stats(const std::vector<PassStats> &stats, std::ostream &out)
+{
+    std::ios::fmtflags flags = out.flags();
+    std::streamsize precision = out.precision();
+    out << std::fixed << std::setprecision(3);
+    size_t nameWidth = 4;
+    for (const auto &st : stats)
+        nameWidth = std::max(nameWidth, st.pass.size());
+    unsigned long long totalNs = 0;
+    size_t removed = 0;
+    out << std::left << std::setw((int)nameWidth) << "pass" << std::right << std::setw(10) << "ms" << std::setw(10)
+        << "before" << std::setw(10) << "after" << std::setw(10) << "removed" << "\n";
+    for (const auto &st : stats)
+    {
+        // Passe que expande o código aparece com remoção negativa
+        long diff = (long)st.before - (long)st.after;
+        out << std::left << std::setw((int)nameWidth) << st.pass << std::right << std::setw(10) << st.ns / 1e6
+            << std::setw(10) << st.before << std::setw(10) << st.after << std::setw(10) << diff << "\n";
+        totalNs += st.ns;
+        removed += st.before > st.after ? st.before - st.after : 0;
+    }
+    out << std::left << std::setw((int)nameWidth) << "total" << std::right << std::setw(10) << totalNs / 1e6;
+    if (!stats.empty())
+        out << std::setw(10) << stats.front().before << std::setw(10) << stats.back().after << std::setw(10)
+            << (long)stats.front().before - (long)stats.back().after;
+    out << "\n";
+    out.flags(flags);
+    out.precision(precision);
+}
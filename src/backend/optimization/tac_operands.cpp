@@ -0,0 +1,117 @@
+#include "tac_optimizer.h"
+#include "tac_interpreter.h"
+
+bool tac_is_temp(const std::string &name)
+{
+    return name.size() > 1 && name[0] == 't' && name.find_first_not_of("0123456789", 1) == std::string::npos;
+}
+
+std::vector<std::string *> tac_value_operands(TACInstruction &ins)
+{
+    std::vector<std::string *> ops;
+    auto add = [&](std::string &field)
+    {
+        if (!field.empty())
+            ops.push_back(&field);
+    };
+    switch (decode_tac_op(ins.op))
+    {
+    case TACOp::ASSIGN:
+    case TACOp::NOT:
+    case TACOp::PRINT:
+    case TACOp::PRINT_LAST:
+    case TACOp::IF_FALSE:
+    case TACOp::RETURN:
+    case TACOp::ARRAY_INIT:
+        add(ins.arg1);
+        break;
+    case TACOp::ADD:
+    case TACOp::SUB:
+    case TACOp::MUL:
+    case TACOp::DIV:
+    case TACOp::EQ:
+    case TACOp::NE:
+    case TACOp::LT:
+    case TACOp::LE:
+    case TACOp::GT:
+    case TACOp::GE:
+    case TACOp::AND:
+    case TACOp::OR:
+    case TACOp::ARRAY_SET: // result é o array; valor e índice aceitam literal
+        add(ins.arg1);
+        add(ins.arg2);
+        break;
+    case TACOp::ARRAY_GET:
+        add(ins.arg2);
+        break;
+    case TACOp::SEND_MSG:
+        for (auto &a : ins.args)
+            add(a);
+        break;
+    default:
+        break;
+    }
+    return ops;
+}
+
+std::vector<const std::string *> tac_written_names(const TACInstruction &ins)
+{
+    std::vector<const std::string *> names;
+    switch (decode_tac_op(ins.op))
+    {
+    case TACOp::PRINT:
+    case TACOp::PRINT_LAST:
+    case TACOp::LABEL:
+    case TACOp::IF_FALSE:
+    case TACOp::GOTO:
+    case TACOp::RETURN:
+    case TACOp::SEND_MSG:
+    case TACOp::NOP: // input e operações desconhecidas não escrevem no interpretador
+        break;
+    case TACOp::RECV_MSG:
+    case TACOp::TAKE_MSG:
+        for (const auto &a : ins.args)
+            names.push_back(&a);
+        break;
+    default:
+        if (!ins.result.empty())
+            names.push_back(&ins.result);
+        break;
+    }
+    return names;
+}
+
+bool tac_is_pure(const TACInstruction &ins)
+{
+    switch (decode_tac_op(ins.op))
+    {
+    case TACOp::ASSIGN:
+    case TACOp::ADD:
+    case TACOp::SUB:
+    case TACOp::MUL:
+    case TACOp::DIV:
+    case TACOp::EQ:
+    case TACOp::NE:
+    case TACOp::LT:
+    case TACOp::LE:
+    case TACOp::GT:
+    case TACOp::GE:
+    case TACOp::AND:
+    case TACOp::OR:
+    case TACOp::NOT:
+    case TACOp::ARRAY_CONCAT:
+    case TACOp::ARRAY_INIT:
+    case TACOp::ARRAY_GET:
+        return !ins.result.empty();
+    default:
+        return false;
+    }
+}
+
+int tac_mentions(const TACInstruction &ins, const std::string &name)
+{
+    int n = (ins.result == name) + (ins.arg1 == name) + (ins.arg2 == name);
+    for (const auto &a : ins.args)
+        n += a == name;
+    return n;
+}
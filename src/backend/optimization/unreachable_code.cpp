@@ -0,0 +1,67 @@
+#include "tac_optimizer.h"
+#include <cstdint>
+#include <unordered_set>
+
+namespace
+{
+    class UnreachableCodePass : public TACPass
+    {
+    public:
+        const char *name() const override { return "unreachable-code"; }
+
+        void run(std::vector<TACInstruction> &code) override
+        {
+            // Só goto encerra o fluxo: return fora de chamada segue para a próxima instrução no interpretador,
+            // e todo destino de salto (inclusive a entrada de função) é um label
+            std::vector<TACInstruction> kept;
+            kept.reserve(code.size());
+            bool reachable = true;
+            size_t pendingGoto = SIZE_MAX; // último goto mantido, seguido só de labels
+            for (auto &ins : code)
+            {
+                if (ins.op == "label")
+                {
+                    // goto para um dos labels logo adiante (ex.: `ret` no fim do corpo) não muda o fluxo
+                    if (pendingGoto != SIZE_MAX && kept[pendingGoto].arg1 == ins.result)
+                    {
+                        kept.erase(kept.begin() + pendingGoto);
+                        pendingGoto = SIZE_MAX;
+                    }
+                    reachable = true;
+                    kept.push_back(std::move(ins));
+                    continue;
+                }
+                if (!reachable)
+                    continue;
+                pendingGoto = ins.op == "goto" ? kept.size() : SIZE_MAX;
+                kept.push_back(std::move(ins));
+                if (kept.back().op == "goto")
+                    reachable = false;
+            }
+            // Labels sem referência custam uma instrução executada cada vez que o fluxo passa por eles. O label
+            // de retorno de cada função chamada fica: o interpretador delimita o corpo por ele.
+            std::unordered_set<std::string> targets;
+            for (const auto &ins : kept)
+            {
+                if (ins.op == "goto")
+                    targets.insert(ins.arg1);
+                else if (ins.op == "call")
+                {
+                    targets.insert(ins.arg1);
+                    targets.insert("L_return_" + ins.arg1);
+                }
+                else if (ins.op == "if_false")
+                    targets.insert(ins.arg2);
+            }
+            code.clear();
+            for (auto &ins : kept)
+                if (ins.op != "label" || targets.count(ins.result))
+                    code.push_back(std::move(ins));
+        }
+    };
+}
+
+std::unique_ptr<TACPass> make_unreachable_code_pass()
+{
+    return std::unique_ptr<TACPass>(new UnreachableCodePass());
+}
@@ -2,6 +2,7 @@
 #include "lexer.h"
 #include "parser.h"
 #include "tac_generator.h"
+#include "tac_optimizer.h"
 #include "arm_generator.h"
 #include "ast_printer.h"
 #include "symbol_table.h"
@@ -26,6 +27,29 @@ string get_current_timestamp()
     return ss.str();
 }
 
+// Nível de otimização do TAC aplicado por todas as funções exportadas (set_optimization_level)
+static OptLevel optimizationLevel = OptLevel::O0;
+
+EMSCRIPTEN_KEEPALIVE
+void set_optimization_level(int level)
+{
+    optimizationLevel = level <= 0 ? OptLevel::O0 : (level == 1 ? OptLevel::O1 : OptLevel::O2);
+}
+
+// Relatório dos passes em JSON: {"level":N,"passes":[{"name":...,"ms":...,"before":...,"after":...,"removed":...}]}
+static void build_pass_stats_json(stringstream &json, const PassManager &passes)
+{
+    json << "{\"level\":" << (int)passes.level() << ",\"passes\":[";
+    const auto &stats = passes.stats();
+    for (size_t i = 0; i < stats.size(); ++i)
+    {
+        const auto &st = stats[i];
+        json << (i ? "," : "") << "{\"name\":\"" << st.pass << "\",\"ms\":" << st.ns / 1e6 << ",\"before\":" << st.before
+             << ",\"after\":" << st.after << ",\"removed\":" << (long)st.before - (long)st.after << "}";
+    }
+    json << "]}";
+}
+
 // Função para converter tipo de token para string
 string token_type_to_string(TokenType type)
 {
@@ -41,6 +65,8 @@ string token_type_to_string(TokenType type)
         return "KEYWORD";
     case TokenType::INPUT:
         return "KEYWORD";
+    case TokenType::SELECT:
+        return "KEYWORD";
     case TokenType::IDENTIFIER:
         return "IDENTIFIER";
     case TokenType::NUMBER:
@@ -91,6 +117,12 @@ std::string interpretTAC(const std::string &tacCode)
     std::vector<std::string> outputLines;
     std::map<std::string, size_t> labels;
     std::vector<std::string> instructions;
+    // Literal inteiro (com sinal): o TAC otimizado traz constantes direto nos operandos
+    auto isIntLiteral = [](const std::string &s)
+    {
+        size_t start = (!s.empty() && s[0] == '-') ? 1 : 0;
+        return s.size() > start && s.find_first_not_of("0123456789", start) == std::string::npos;
+    };
 
     // Primeira passada: extrair instruções e labels
     std::istringstream iss(tacCode);
@@ -135,6 +167,10 @@ std::string interpretTAC(const std::string &tacCode)
             {
                 outputLines.push_back(std::to_string(variables[varName]));
             }
+            else if (isIntLiteral(varName))
+            {
+                outputLines.push_back(varName);
+            }
             else
             {
                 outputLines.push_back("[undefined variable: " + varName + "]");
@@ -191,7 +227,7 @@ std::string interpretTAC(const std::string &tacCode)
                 // Placeholder: sem interação real, definir 0
                 value = 0;
             }
-            else if (right.find_first_not_of("0123456789") == std::string::npos)
+            else if (isIntLiteral(right))
             {
                 value = std::stoi(right);
             }
@@ -413,6 +449,7 @@ char *compile_minipar(const char *source_code)
     {
         vector<TACInstruction> tac;
         string tacText;
+        PassManager passes{optimizationLevel};
     };
     auto build_intermediate = [&](stringstream &json, ASTNode *ast)
     {
@@ -422,8 +459,9 @@ char *compile_minipar(const char *source_code)
         {
             TACGenerator gen;
             res.tac = gen.generate(static_cast<ProgramNode *>(ast));
+            res.passes.run(res.tac);
             stringstream ss;
-            gen.print_tac(ss);
+            TACGenerator::print(res.tac, ss);
             res.tacText = ss.str();
             json << "\"tac\":[";
             for (size_t i = 0; i < res.tac.size(); ++i)
@@ -454,13 +492,22 @@ char *compile_minipar(const char *source_code)
                     if (!first)
                         json << ",";
                     json << "\"" << escape_json(instr.arg2) << "\"";
+                    first = false;
+                }
+                for (const auto &a : instr.args)
+                {
+                    if (!first)
+                        json << ",";
+                    json << "\"" << escape_json(a) << "\"";
+                    first = false;
                 }
                 bool isTemp = (instr.result.find("t") == 0) && (instr.result.find_first_not_of("0123456789", 1) == string::npos);
                 json << "],\"isTemporary\":" << (isTemp ? "true" : "false") << "}";
                 if (i + 1 < res.tac.size())
                     json << ",";
             }
-            json << "]";
+            json << "],\"optimization\":";
+            build_pass_stats_json(json, res.passes);
         }
         else
         {
@@ -585,6 +632,8 @@ char *compile_minipar_json(const char *source_code)
         {
             TACGenerator tac_gen;
             auto tac = tac_gen.generate(ast.get());
+            PassManager passes(optimizationLevel);
+            passes.run(tac);
 
             // Symbol table JSON
             SymbolTable symtab;
@@ -659,7 +708,9 @@ char *compile_minipar_json(const char *source_code)
                     json_result << ",";
                 }
             }
-            json_result << "],";
+            json_result << "],\"optimization\":";
+            build_pass_stats_json(json_result, passes);
+            json_result << ",";
 
             // 4. Código ARM
             ARMGenerator arm_gen;
@@ -718,6 +769,8 @@ char *compile_minipar_tac(const char *source_code)
             // Gerar TAC
             TACGenerator tac_gen;
             auto tac = tac_gen.generate(ast.get());
+            PassManager passes(optimizationLevel);
+            passes.run(tac);
 
             json_result << "\"success\": true,";
             json_result << "\"tac\":[";
@@ -765,7 +818,8 @@ char *compile_minipar_tac(const char *source_code)
                     json_result << ",";
                 }
             }
-            json_result << "]";
+            json_result << "],\"optimization\":";
+            build_pass_stats_json(json_result, passes);
         }
         else
         {
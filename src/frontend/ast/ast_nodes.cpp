@@ -33,7 +33,8 @@ std::string VarDeclNode::toString() const
 void ChannelDeclNode::accept(ASTVisitor &visitor) { visitor.visit(*this); }
 std::string ChannelDeclNode::toString() const
 {
-    return "Channel(" + name + ": " + comp1 + " <-> " + comp2 + ")";
+    return "Channel(" + name + ": " + comp1 + " <-> " + comp2 +
+           (capacity > 0 ? ", capacity=" + std::to_string(capacity) : "") + (broadcast ? ", broadcast" : "") + ")";
 }
 
 // AssignmentNode
@@ -74,6 +75,20 @@ std::string ReceiveNode::toString() const
     return "Receive(" + channelName + ", " + std::to_string(variables.size()) + " vars, comp=" + (component.empty() ? "?" : component) + ")";
 }
 
+// SelectNode
+void SelectNode::accept(ASTVisitor &visitor) { visitor.visit(*this); }
+std::string SelectNode::toString() const
+{
+    return "Select(" + std::to_string(cases.size()) + " cases)";
+}
+
+// GlobalDeclNode
+void GlobalDeclNode::accept(ASTVisitor &visitor) { visitor.visit(*this); }
+std::string GlobalDeclNode::toString() const
+{
+    return "Global(" + std::to_string(names.size()) + " names)";
+}
+
 // IfNode
 void IfNode::accept(ASTVisitor &visitor) { visitor.visit(*this); }
 std::string IfNode::toString() const
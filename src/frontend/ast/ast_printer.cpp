@@ -99,7 +99,9 @@ void ASTPrinter::visit(VarDeclNode &node)
 
 void ASTPrinter::visit(ChannelDeclNode &node)
 {
-    printLine("Channel: " + node.name + " (" + node.comp1 + " <-> " + node.comp2 + ")");
+    printLine("Channel: " + node.name + " (" + node.comp1 + " <-> " + node.comp2 + ")" +
+              (node.capacity > 0 ? " capacity=" + std::to_string(node.capacity) : "") +
+              (node.broadcast ? " broadcast" : ""));
 }
 
 void ASTPrinter::visit(AssignmentNode &node)
@@ -169,6 +171,27 @@ void ASTPrinter::visit(ReceiveNode &node)
     }
 }
 
+void ASTPrinter::visit(SelectNode &node)
+{
+    printLine("Select:");
+    indentLevel++;
+    for (size_t k = 0; k < node.cases.size(); ++k)
+    {
+        node.cases[k]->accept(*this);
+        indentLevel++;
+        node.bodies[k]->accept(*this);
+        indentLevel--;
+    }
+    indentLevel--;
+}
+
+void ASTPrinter::visit(GlobalDeclNode &node)
+{
+    printLine("Global:");
+    for (const auto &name : node.names)
+        printLine("  -> " + name);
+}
+
 void ASTPrinter::visit(IfNode &node)
 {
     printLine("If:");
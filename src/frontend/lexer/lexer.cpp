@@ -17,6 +17,9 @@ static unordered_map<string, TokenType> keywords = {
     {"true", TokenType::TRUE},
     {"false", TokenType::FALSE},
     {"comp", TokenType::COMP},
+    {"select", TokenType::SELECT},
+    {"broadcast", TokenType::BROADCAST},
+    {"global", TokenType::GLOBAL},
     {"int", TokenType::INT},
     {"bool", TokenType::BOOL},
     {"string", TokenType::STRING},
@@ -1,4 +1,6 @@
 #include "parser.h"
+#include <cerrno>
+#include <cstdlib>
 #include <iostream>
 #include <sstream>
 #ifdef MINIPAR_DEBUG
@@ -53,6 +55,15 @@ void Parser::setComponent(const std::string &name)
     currentComponent = name;
 }
 
+void Parser::error(const Token &at, const std::string &message)
+{
+    parseErrors.push_back("linha " + std::to_string(at.line) + ": " + message);
+}
+
+// Teto da capacidade declarada de um canal: o anel reserva no máximo SharedChannel::RING_SLOTS posições
+// e o resto cresce sob demanda, mas um limite absurdo é quase sempre erro de digitação
+static const long MAX_CHANNEL_CAPACITY = 1L << 24;
+
 unique_ptr<ProgramNode> Parser::parse()
 {
     auto program = make_unique<ProgramNode>();
@@ -71,7 +82,7 @@ unique_ptr<ProgramNode> Parser::parse()
         }
         if (match(C_CHANNEL))
         {
-            // c_channel name comp1 comp2
+            // c_channel name comp1 comp2 [capacidade] [broadcast]
             consume();
             if (match(IDENTIFIER))
             {
@@ -83,10 +94,37 @@ unique_ptr<ProgramNode> Parser::parse()
                 std::string c2 = match(IDENTIFIER) ? current().value : "";
                 if (match(IDENTIFIER))
                     consume();
+                int capacity = 0;
+                bool negative = match(MINUS) && peek().type == NUMBER;
+                if (negative)
+                    consume();
+                if (match(NUMBER))
+                {
+                    errno = 0;
+                    char *end = nullptr;
+                    long value = std::strtol(current().value.c_str(), &end, 10);
+                    bool integral = end && *end == '\0' && errno != ERANGE;
+                    if (negative || !integral || value <= 0 || value > MAX_CHANNEL_CAPACITY)
+                        error(current(), "capacidade do canal '" + chName + "' deve ser um inteiro entre 1 e " +
+                                             std::to_string(MAX_CHANNEL_CAPACITY) + " (lido '" +
+                                             (negative ? "-" : "") + current().value + "')");
+                    else
+                        capacity = static_cast<int>(value);
+                    consume();
+                }
+                bool broadcast = false;
+                if (match(BROADCAST))
+                {
+                    broadcast = true;
+                    broadcastChannels.insert(chName);
+                    consume();
+                }
                 auto chDecl = make_unique<ChannelDeclNode>();
                 chDecl->name = chName;
                 chDecl->comp1 = c1;
                 chDecl->comp2 = c2;
+                chDecl->capacity = capacity;
+                chDecl->broadcast = broadcast;
                 program->statements.push_back(std::move(chDecl));
                 continue;
             }
@@ -127,6 +165,7 @@ unique_ptr<ProgramNode> Parser::parse()
             }
             // body: exigir '{' para funções; parse até '}' exclusivo
             std::unique_ptr<ASTNode> bodyNode;
+            inFunction = true;
             if (match(LBRACE))
             {
                 consume(); // '{'
@@ -162,6 +201,7 @@ unique_ptr<ProgramNode> Parser::parse()
                 // Função sem '{' trata próxima statement única como corpo
                 bodyNode = parse_statement();
             }
+            inFunction = false;
             auto fdecl = make_unique<FunctionDeclNode>();
             fdecl->name = fname;
             fdecl->params = params;
@@ -181,9 +221,19 @@ unique_ptr<ProgramNode> Parser::parse()
             consume(); // consumir PAR
             auto par = make_unique<ParNode>();
 
-            // Parse todos os SEQ dentro do PAR
-            while (match(SEQ))
+            // Parse todos os SEQ dentro do PAR; `comp nome` entre eles muda o componente dos ramos seguintes
+            while (match(SEQ) || match(COMP))
             {
+                if (match(COMP))
+                {
+                    consume();
+                    if (match(IDENTIFIER))
+                    {
+                        setComponent(current().value);
+                        consume();
+                    }
+                    continue;
+                }
                 auto seq = parse_seq_block();
                 par->statements.push_back(std::move(seq));
             }
@@ -204,6 +254,11 @@ unique_ptr<ProgramNode> Parser::parse()
         }
     }
 
+    // Assinante de difusão dentro de select pode atender outro caso e nunca avançar o cursor, segurando a
+    // posição do anel para todos os demais. No fim porque a declaração pode vir depois do select.
+    for (const auto &sc : selectCases)
+        if (broadcastChannels.count(sc.second))
+            error(sc.first, "canal broadcast '" + sc.second + "' não pode ser caso de select");
     return program;
 }
 
@@ -226,7 +281,7 @@ unique_ptr<SeqNode> Parser::parse_seq_block()
     {
         if (hasBrace && match(RBRACE))
             break;
-        if (!hasBrace && (match(SEQ) || match(PAR) || match(ELSE) || match(RBRACE)))
+        if (!hasBrace && (match(SEQ) || match(PAR) || match(COMP) || match(ELSE) || match(RBRACE)))
             break;
         auto stmt = parse_statement();
         if (stmt)
@@ -461,6 +516,32 @@ unique_ptr<ASTNode> Parser::parse_statement()
     {
         return parse_if_statement();
     }
+    else if (match(SELECT))
+    {
+        return parse_select_statement();
+    }
+    else if (match(GLOBAL))
+    {
+        // global a, b: nomes de topo que a função lê e escreve
+        Token at = current();
+        consume();
+        auto decl = make_unique<GlobalDeclNode>();
+        while (match(IDENTIFIER))
+        {
+            decl->names.push_back(current().value);
+            consume();
+            if (!match(COMMA))
+                break;
+            consume();
+        }
+        if (decl->names.empty())
+            error(at, "global espera um ou mais nomes");
+        if (!inFunction)
+            error(at, "global só pode aparecer dentro de função");
+        if (match(SEMICOLON))
+            consume();
+        return decl;
+    }
 
     // Se não reconhecer, pular token
     consume();
@@ -845,4 +926,46 @@ unique_ptr<ASTNode> Parser::parse_if_statement()
             ifNode->elseBranch = parse_statement();
     }
     return ifNode;
-}
\ No newline at end of file
+}
+
+unique_ptr<ASTNode> Parser::parse_select_statement()
+{
+    consume(); // SELECT
+    auto selectNode = make_unique<SelectNode>();
+    if (match(LBRACE))
+        consume();
+    // Cada caso: canal.receive(vars) seguido do corpo entre chaves (opcional)
+    while (!match(RBRACE) && !match(END))
+    {
+        Token at = current();
+        auto stmt = parse_statement();
+        auto recv = dynamic_cast<ReceiveNode *>(stmt.get());
+        if (!recv)
+        {
+            // Comando solto entre os casos seria descartado em silêncio: o corpo vai entre chaves após o receive
+            error(at, "select aceita apenas casos canal.receive(...) { ... } (encontrado '" + at.value + "')");
+            continue;
+        }
+        stmt.release();
+        selectCases.emplace_back(at, recv->channelName);
+        selectNode->cases.emplace_back(recv);
+        auto body = make_unique<SeqNode>();
+        if (match(LBRACE))
+        {
+            consume();
+            while (!match(RBRACE) && !match(END))
+            {
+                auto inner = parse_statement();
+                if (inner)
+                    body->statements.push_back(std::move(inner));
+            }
+            if (match(RBRACE))
+                consume();
+        }
+        selectNode->bodies.push_back(std::move(body));
+    }
+    if (match(RBRACE))
+        consume();
+    DBG("[PARSE] select cases=" << selectNode->cases.size() << " tokenIndex=" << current_token << "\n");
+    return selectNode;
+}
@@ -0,0 +1,241 @@
+#include "channel_fusion.h"
+#include "semantic_channels.h"
+#include <unordered_map>
+#include <unordered_set>
+
+// Efeitos de um ramo além dos canais: prints (ordem da saída), chamada/entrada (efeitos não analisados) e
+// variáveis lidas e escritas (a fusão põe produtor e consumidor no mesmo ambiente)
+struct BranchEffects
+{
+    bool prints = false;
+    bool opaque = false;
+    std::unordered_set<std::string> reads;
+    std::unordered_set<std::string> writes;
+};
+
+static void scan(ASTNode *node, BranchEffects &fx)
+{
+    if (!node)
+        return;
+    if (auto print = dynamic_cast<PrintNode *>(node))
+    {
+        fx.prints = true;
+        for (auto &e : print->expressions)
+            scan(e.get(), fx);
+    }
+    else if (auto call = dynamic_cast<CallNode *>(node))
+    {
+        fx.opaque = true;
+        for (auto &a : call->args)
+            scan(a.get(), fx);
+    }
+    else if (auto input = dynamic_cast<InputNode *>(node))
+    {
+        fx.opaque = true;
+        fx.writes.insert(input->identifier);
+    }
+    else if (dynamic_cast<InputCallNode *>(node))
+        fx.opaque = true;
+    else if (auto id = dynamic_cast<IdentifierNode *>(node))
+        fx.reads.insert(id->name);
+    else if (auto seq = dynamic_cast<SeqNode *>(node))
+    {
+        for (auto &s : seq->statements)
+            scan(s.get(), fx);
+    }
+    else if (auto par = dynamic_cast<ParNode *>(node))
+    {
+        for (auto &s : par->statements)
+            scan(s.get(), fx);
+    }
+    else if (auto decl = dynamic_cast<VarDeclNode *>(node))
+    {
+        scan(decl->initializer.get(), fx);
+        fx.writes.insert(decl->name);
+    }
+    else if (auto assign = dynamic_cast<AssignmentNode *>(node))
+    {
+        scan(assign->expression.get(), fx);
+        fx.writes.insert(assign->identifier);
+    }
+    else if (auto arrAssign = dynamic_cast<ArrayAssignmentNode *>(node))
+    {
+        // Escrita de elemento lê e escreve o array base
+        scan(arrAssign->array.get(), fx);
+        if (auto base = dynamic_cast<IdentifierNode *>(arrAssign->array.get()))
+            fx.writes.insert(base->name);
+        scan(arrAssign->index.get(), fx);
+        scan(arrAssign->value.get(), fx);
+    }
+    else if (auto send = dynamic_cast<SendNode *>(node))
+    {
+        for (auto &a : send->arguments)
+            scan(a.get(), fx);
+    }
+    else if (auto recv = dynamic_cast<ReceiveNode *>(node))
+    {
+        for (auto &v : recv->variables)
+            fx.writes.insert(v);
+    }
+    else if (auto sel = dynamic_cast<SelectNode *>(node))
+    {
+        for (size_t k = 0; k < sel->cases.size(); ++k)
+        {
+            scan(sel->cases[k].get(), fx);
+            scan(sel->bodies[k].get(), fx);
+        }
+    }
+    else if (auto w = dynamic_cast<WhileNode *>(node))
+    {
+        scan(w->condition.get(), fx);
+        scan(w->body.get(), fx);
+    }
+    else if (auto ifn = dynamic_cast<IfNode *>(node))
+    {
+        scan(ifn->condition.get(), fx);
+        scan(ifn->thenBranch.get(), fx);
+        scan(ifn->elseBranch.get(), fx);
+    }
+    else if (auto ret = dynamic_cast<ReturnNode *>(node))
+        scan(ret->value.get(), fx);
+    else if (auto bin = dynamic_cast<BinaryOpNode *>(node))
+    {
+        scan(bin->left.get(), fx);
+        scan(bin->right.get(), fx);
+    }
+    else if (auto un = dynamic_cast<UnaryOpNode *>(node))
+        scan(un->operand.get(), fx);
+    else if (auto lit = dynamic_cast<ArrayLiteralNode *>(node))
+    {
+        for (auto &e : lit->elements)
+            scan(e.get(), fx);
+    }
+    else if (auto acc = dynamic_cast<ArrayAccessNode *>(node))
+    {
+        scan(acc->base.get(), fx);
+        scan(acc->index.get(), fx);
+    }
+}
+
+// O consumidor fundido roda depois do produtor no mesmo ambiente: colide com ele se lê ou escreve, em
+// qualquer profundidade, um nome que o produtor escreveu antes de o próprio consumidor atribuí-lo num
+// comando de topo (incondicional); escrita dentro de while/if/select não conta como definição
+static bool reads_producer_writes(SeqNode *consumer, const std::unordered_set<std::string> &producerWrites)
+{
+    std::unordered_set<std::string> defined;
+    for (auto &stmt : consumer->statements)
+    {
+        BranchEffects fx;
+        scan(stmt.get(), fx);
+        std::string topWrite;
+        if (auto assign = dynamic_cast<AssignmentNode *>(stmt.get()))
+            topWrite = assign->identifier;
+        else if (auto decl = dynamic_cast<VarDeclNode *>(stmt.get()))
+            topWrite = decl->name;
+        for (const auto &name : fx.reads)
+            if (producerWrites.count(name) && !defined.count(name))
+                return true;
+        for (const auto &name : fx.writes)
+            if (producerWrites.count(name) && !defined.count(name) && name != topWrite)
+                return true;
+        if (!topWrite.empty())
+            defined.insert(topWrite);
+    }
+    return false;
+}
+
+// Número de usuários de cada canal no programa: cada ramo de PAR, função ou comando fora de PAR conta um
+static std::unordered_map<std::string, int> channel_users(ProgramNode *program)
+{
+    std::unordered_map<std::string, int> users;
+    for (auto &st : program->statements)
+    {
+        if (auto par = dynamic_cast<ParNode *>(st.get()))
+        {
+            for (auto &branch : par->statements)
+                for (auto &entry : collect_channel_arities(branch.get()))
+                    ++users[entry.first];
+        }
+        else
+            for (auto &entry : collect_channel_arities(st.get()))
+                ++users[entry.first];
+    }
+    return users;
+}
+
+// Procura um par produtor/consumidor fundível no bloco e o funde; false se não houver
+static bool fuse_one(ParNode *par, const std::unordered_map<std::string, int> &users,
+                     const std::unordered_map<std::string, int> &capacities, FusedChannel &fused)
+{
+    std::vector<std::unordered_map<std::string, ChannelArityInfo>> info;
+    for (auto &branch : par->statements)
+        info.push_back(collect_channel_arities(branch.get()));
+    for (size_t s = 0; s < info.size(); ++s)
+    {
+        if (!dynamic_cast<SeqNode *>(par->statements[s].get()))
+            continue;
+        // Produtor: envia num único canal compartilhado, sem receber dele; os demais canais são só seus
+        const std::string *chan = nullptr;
+        bool candidate = true;
+        for (auto &entry : info[s])
+        {
+            if (users.at(entry.first) == 1)
+                continue;
+            if (chan || !entry.second.recvArities.empty() || users.at(entry.first) != 2 ||
+                capacities.count(entry.first))
+            {
+                candidate = false;
+                break;
+            }
+            chan = &entry.first;
+        }
+        if (!candidate || !chan)
+            continue;
+        for (size_t r = 0; r < info.size(); ++r)
+        {
+            auto it = info[r].find(*chan);
+            if (r == s || it == info[r].end() || !it->second.sendArities.empty() ||
+                !dynamic_cast<SeqNode *>(par->statements[r].get()))
+                continue;
+            BranchEffects fx;
+            scan(par->statements[s].get(), fx);
+            auto producer = static_cast<SeqNode *>(par->statements[s].get());
+            auto consumer = static_cast<SeqNode *>(par->statements[r].get());
+            if (fx.opaque || (fx.prints && r != s + 1) || reads_producer_writes(consumer, fx.writes))
+                break;
+            // Produtor inteiro e depois consumidor, no lugar do consumidor (saída na mesma ordem)
+            std::unique_ptr<SeqNode> merged(new SeqNode());
+            for (auto &stmt : producer->statements)
+                merged->statements.push_back(std::move(stmt));
+            for (auto &stmt : consumer->statements)
+                merged->statements.push_back(std::move(stmt));
+            fused.channel = *chan;
+            fused.producer = (int)s;
+            fused.consumer = (int)r;
+            par->statements[r] = std::move(merged);
+            par->statements.erase(par->statements.begin() + s);
+            return true;
+        }
+    }
+    return false;
+}
+
+std::vector<FusedChannel> fuse_channel_pairs(ProgramNode *program)
+{
+    std::vector<FusedChannel> fused;
+    if (!program)
+        return fused;
+    auto capacities = channel_capacities(program);
+    int parIndex = 0;
+    for (auto &st : program->statements)
+    {
+        auto par = dynamic_cast<ParNode *>(st.get());
+        if (!par)
+            continue;
+        FusedChannel entry;
+        entry.par = parIndex++;
+        while (fuse_one(par, channel_users(program), capacities, entry))
+            fused.push_back(entry);
+    }
+    return fused;
+}
@@ -1,4 +1,5 @@
 #include "semantic_channels.h"
+#include <algorithm>
 #include <unordered_map>
 
 static void walk(ASTNode *node, std::unordered_map<std::string, ChannelArityInfo> &map)
@@ -32,6 +33,14 @@ static void walk(ASTNode *node, std::unordered_map<std::string, ChannelArityInfo
         map[recv->channelName].recvArities.push_back((int)recv->variables.size());
         map[recv->channelName].recvComponents.push_back(recv->component);
     }
+    else if (auto sel = dynamic_cast<SelectNode *>(node))
+    {
+        for (size_t k = 0; k < sel->cases.size(); ++k)
+        {
+            walk(sel->cases[k].get(), map);
+            walk(sel->bodies[k].get(), map);
+        }
+    }
     else if (auto f = dynamic_cast<FunctionDeclNode *>(node))
     {
         walk(f->body.get(), map);
@@ -59,6 +68,153 @@ static void walk(ASTNode *node, std::unordered_map<std::string, ChannelArityInfo
     // leaf nodes ignored
 }
 
+std::unordered_map<std::string, ChannelArityInfo> collect_channel_arities(ASTNode *root)
+{
+    std::unordered_map<std::string, ChannelArityInfo> info;
+    walk(root, info);
+    return info;
+}
+
+std::unordered_map<std::string, int> channel_message_arities(ProgramNode *program)
+{
+    std::unordered_map<std::string, int> arities;
+    for (auto &entry : collect_channel_arities(program))
+    {
+        int arity = 0;
+        for (int v : entry.second.sendArities)
+            arity = std::max(arity, v);
+        for (int v : entry.second.recvArities)
+            arity = std::max(arity, v);
+        arities[entry.first] = arity;
+    }
+    return arities;
+}
+
+std::unordered_map<std::string, int> channel_capacities(ProgramNode *program)
+{
+    std::unordered_map<std::string, int> capacities;
+    for (auto &st : program->statements)
+        if (auto decl = dynamic_cast<ChannelDeclNode *>(st.get()))
+            if (decl->capacity > 0)
+                capacities[decl->name] = decl->capacity;
+    return capacities;
+}
+
+std::unordered_map<std::string, ChannelTopologyInfo> analyze_channel_topology(ProgramNode *program)
+{
+    std::unordered_map<std::string, ChannelTopologyInfo> topology;
+    if (!program)
+        return topology;
+    // Primeiro ramo SEQ (numerado em todos os PAR) a usar cada canal; uso em outro ramo derruba singleSeq
+    std::unordered_map<std::string, int> owner;
+    int branchId = 0;
+    for (auto &st : program->statements)
+    {
+        if (auto fn = dynamic_cast<FunctionDeclNode *>(st.get()))
+        {
+            // Função pode ser chamada de qualquer ramo, inclusive de vários ao mesmo tempo
+            for (auto &entry : collect_channel_arities(fn))
+            {
+                ChannelTopologyInfo &info = topology[entry.first];
+                info.singleSeq = false;
+                if (!entry.second.sendArities.empty())
+                    info.producers = 2;
+                if (!entry.second.recvArities.empty())
+                    info.consumers = 2;
+            }
+        }
+        else if (auto par = dynamic_cast<ParNode *>(st.get()))
+        {
+            // Blocos PAR rodam um após o outro (join no fim): só ramos do mesmo bloco são concorrentes
+            std::unordered_map<std::string, int> senders, receivers;
+            for (auto &branch : par->statements)
+            {
+                for (auto &entry : collect_channel_arities(branch.get()))
+                {
+                    senders[entry.first] += entry.second.sendArities.empty() ? 0 : 1;
+                    receivers[entry.first] += entry.second.recvArities.empty() ? 0 : 1;
+                    ChannelTopologyInfo &info = topology[entry.first];
+                    if (owner.emplace(entry.first, branchId).first->second != branchId)
+                        info.singleSeq = false;
+                }
+                ++branchId;
+            }
+            for (auto &entry : senders)
+                topology[entry.first].producers = std::max(topology[entry.first].producers, entry.second);
+            for (auto &entry : receivers)
+                topology[entry.first].consumers = std::max(topology[entry.first].consumers, entry.second);
+        }
+        else
+        {
+            // Comandos fora de PAR rodam no programa sequencial, sem concorrência
+            for (auto &entry : collect_channel_arities(st.get()))
+                topology[entry.first];
+        }
+    }
+    for (auto &entry : topology)
+    {
+        ChannelTopologyInfo &info = entry.second;
+        if (info.singleSeq)
+            info.topology = ChannelTopology::LOCAL;
+        else if (info.producers > 1)
+            info.topology = info.consumers > 1 ? ChannelTopology::MPMC : ChannelTopology::MPSC;
+        else
+            info.topology = info.consumers > 1 ? ChannelTopology::SPMC : ChannelTopology::SPSC;
+    }
+    return topology;
+}
+
+std::unordered_set<std::string> broadcast_channels(ProgramNode *program)
+{
+    std::unordered_set<std::string> names;
+    for (auto &st : program->statements)
+        if (auto decl = dynamic_cast<ChannelDeclNode *>(st.get()))
+            if (decl->broadcast)
+                names.insert(decl->name);
+    return names;
+}
+
+std::unordered_map<std::string, int> channel_subscribers(ParNode *par)
+{
+    std::unordered_map<std::string, int> subscribers;
+    for (auto &branch : par->statements)
+        if (dynamic_cast<SeqNode *>(branch.get()))
+            for (auto &entry : collect_channel_arities(branch.get()))
+                if (!entry.second.recvArities.empty())
+                    ++subscribers[entry.first];
+    return subscribers;
+}
+
+std::vector<std::string> broadcast_channel_errors(ProgramNode *program)
+{
+    std::vector<std::string> errors;
+    auto broadcast = broadcast_channels(program);
+    for (auto &st : program->statements)
+        if (auto fn = dynamic_cast<FunctionDeclNode *>(st.get()))
+            for (auto &entry : collect_channel_arities(fn))
+                if (broadcast.count(entry.first) && !entry.second.recvArities.empty())
+                    errors.push_back("canal broadcast '" + entry.first + "' é recebido dentro da função '" + fn->name +
+                                     "'");
+    return errors;
+}
+
+const char *channel_topology_name(ChannelTopology topology)
+{
+    switch (topology)
+    {
+    case ChannelTopology::LOCAL:
+        return "LOCAL";
+    case ChannelTopology::SPSC:
+        return "SPSC";
+    case ChannelTopology::MPSC:
+        return "MPSC";
+    case ChannelTopology::SPMC:
+        return "SPMC";
+    default:
+        return "MPMC";
+    }
+}
+
 void analyze_channel_arities(ProgramNode *program, std::ostream &out)
 {
     if (!program)
@@ -66,13 +222,13 @@ void analyze_channel_arities(ProgramNode *program, std::ostream &out)
         out << "<no program>\n";
         return;
     }
-    std::unordered_map<std::string, ChannelArityInfo> info;
-    walk(program, info);
+    auto info = collect_channel_arities(program);
     if (info.empty())
     {
         out << "Nenhum canal com operações send/receive.\n";
         return;
     }
+    auto topology = analyze_channel_topology(program);
     for (auto &entry : info)
     {
         const auto &name = entry.first;
@@ -153,6 +309,7 @@ void analyze_channel_arities(ProgramNode *program, std::ostream &out)
             else
                 out << "MISMATCH (send=" << ci.sendArities[0] << " recv=" << ci.recvArities[0] << ")";
         }
+        out << " topologia=" << channel_topology_name(topology[name].topology);
         out << "\n";
     }
 }
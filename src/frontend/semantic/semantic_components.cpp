@@ -0,0 +1,98 @@
+#include "semantic_components.h"
+#include "semantic_channels.h"
+#include <algorithm>
+#include <map>
+#include <set>
+
+static void add_unique(std::vector<std::string> &list, const std::string &name)
+{
+    if (std::find(list.begin(), list.end(), name) == list.end())
+        list.push_back(name);
+}
+
+std::string branch_component(SeqNode *seq)
+{
+    for (auto &entry : collect_channel_arities(seq))
+    {
+        for (const auto &comp : entry.second.sendComponents)
+            if (!comp.empty())
+                return comp;
+        for (const auto &comp : entry.second.recvComponents)
+            if (!comp.empty())
+                return comp;
+    }
+    return "";
+}
+
+ComponentLayout analyze_components(ProgramNode *program)
+{
+    ComponentLayout layout;
+    if (!program)
+        return layout;
+    std::map<std::string, std::vector<std::string>> senders, receivers;
+    std::set<std::string> inFunctions;
+    auto broadcast = broadcast_channels(program);
+    for (auto &st : program->statements)
+    {
+        if (auto fn = dynamic_cast<FunctionDeclNode *>(st.get()))
+        {
+            for (auto &entry : collect_channel_arities(fn))
+                inFunctions.insert(entry.first);
+        }
+        else if (auto par = dynamic_cast<ParNode *>(st.get()))
+        {
+            for (auto &branch : par->statements)
+            {
+                auto seq = dynamic_cast<SeqNode *>(branch.get());
+                if (!seq)
+                    continue;
+                std::string comp = branch_component(seq);
+                add_unique(layout.components, comp);
+                for (auto &entry : collect_channel_arities(seq))
+                {
+                    if (!entry.second.sendArities.empty())
+                        add_unique(senders[entry.first], comp);
+                    if (!entry.second.recvArities.empty())
+                        add_unique(receivers[entry.first], comp);
+                }
+            }
+        }
+    }
+    std::set<std::string> names;
+    for (auto &entry : senders)
+        names.insert(entry.first);
+    for (auto &entry : receivers)
+        names.insert(entry.first);
+    for (const auto &name : names)
+    {
+        std::vector<std::string> users = senders[name];
+        for (const auto &comp : receivers[name])
+            add_unique(users, comp);
+        if (users.size() < 2)
+            continue;
+        if (receivers[name].size() > 1)
+        {
+            layout.errors.push_back("canal '" + name + "' é recebido por mais de um componente");
+            continue;
+        }
+        if (broadcast.count(name))
+        {
+            // Um anel por emissor e um leitor por processo: a difusão só existe dentro de um componente
+            layout.errors.push_back("canal broadcast '" + name + "' liga componentes");
+            continue;
+        }
+        if (inFunctions.count(name))
+        {
+            layout.errors.push_back("canal '" + name + "' liga componentes e é usado dentro de função");
+            continue;
+        }
+        CrossChannel cross;
+        cross.name = name;
+        cross.senders = senders[name];
+        cross.hasReceiver = !receivers[name].empty();
+        if (cross.hasReceiver)
+            cross.receiver = receivers[name].front();
+        layout.channels.push_back(cross);
+    }
+    return layout;
+}
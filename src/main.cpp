@@ -3,16 +3,23 @@
 #include <sstream>
 #include <iomanip>
 #include <chrono>
-#include <thread>
-#include <mutex>
+#include <algorithm>
+#include <cstdlib>
+#include <memory>
 #include "lexer.h"
 #include "parser.h"
 #include "ast_printer.h"
 #include "tac_generator.h"
+#include "tac_optimizer.h"
 #include "arm_generator.h"
 #include "symbol_table.h"
 #include "tac_interpreter.h"
 #include "semantic_channels.h"
+#include "channel_fusion.h"
+#include "semantic_components.h"
+#include "component_processes.h"
+#include "scheduler.h"
+#include "shared_channel.h"
 
 using namespace std;
 
@@ -30,6 +37,333 @@ string read_file(const string &filename)
     return buffer.str();
 }
 
+// Ramo SEQ de um bloco PAR como tarefa leve do escalonador. TAC e interpretador nascem na primeira fatia
+// e são descartados ao terminar; da tarefa concluída restam apenas a saída acumulada e o erro de execução.
+class SeqTask : public GreenTask
+{
+public:
+    // localMetrics não nulo liga as métricas de canal; as das filas locais do ramo são somadas nele no fim.
+    // O TAC do ramo passa pelos passes do nível optLevel antes de ser carregado.
+    SeqTask(SeqNode *seq, const std::unordered_map<std::string, int> &arities,
+            const std::unordered_map<std::string, int> &capacities, const SharedChannelMap &channels,
+            Scheduler &scheduler, ChannelMetricsMap *localMetrics, OptLevel optLevel)
+        : seq(seq), arities(arities), capacities(capacities), channels(channels), scheduler(scheduler),
+          localMetrics(localMetrics), optLevel(optLevel)
+    {
+        // Mesma contagem de begin_broadcast_block: o ramo assina os canais em que recebe, mesmo que o TAC
+        // otimizado não tenha mais o receive
+        for (const auto &entry : collect_channel_arities(seq))
+            if (!entry.second.recvArities.empty())
+                receives.push_back(entry.first);
+    }
+
+    TaskStatus step() override
+    {
+        if (!interpreter)
+        {
+            TACGenerator gen;
+            tac = gen.generate_from_seq(seq);
+            PassManager(optLevel).run(tac);
+            interpreter.reset(new TACInterpreter());
+            interpreter->setChannelArities(arities);
+            interpreter->setChannelCapacities(capacities);
+            interpreter->setBlockingReceive(true);
+            interpreter->setSharedChannels(&channels);
+            interpreter->setChannelMetrics(localMetrics != nullptr);
+            Scheduler *sched = &scheduler;
+            interpreter->setChannelWake([sched](const void *key)
+                                        { sched->notify(key); });
+            interpreter->start(tac);
+        }
+        switch (interpreter->run(out, SLICE))
+        {
+        case RunStatus::YIELD:
+            return TaskStatus::YIELD;
+        case RunStatus::BLOCKED:
+            return TaskStatus::BLOCKED;
+        case RunStatus::POLL:
+            return TaskStatus::POLL;
+        default:
+            if (localMetrics)
+                for (const auto &entry : interpreter->localChannels())
+                {
+                    auto total = localMetrics->find(entry.first);
+                    if (total != localMetrics->end())
+                        total->second->merge(entry.second.metrics);
+                }
+            error = interpreter->error();
+            interpreter->leaveBroadcasts(receives);
+            interpreter.reset();
+            std::vector<TACInstruction>().swap(tac);
+            return TaskStatus::DONE;
+        }
+    }
+    const void *waitKey() const override { return interpreter->blockedOn(); }
+    const std::vector<const void *> *waitKeys() const override { return &interpreter->blockedOnAll(); }
+    bool ready() const override { return interpreter->canResume(); }
+    void release() override { interpreter->releaseReceive(); }
+
+    std::stringstream out;
+    std::string error; // vazio se o ramo terminou sem erro de execução
+
+private:
+    static const unsigned long long SLICE = 20000; // instruções por fatia
+    SeqNode *seq;
+    const std::unordered_map<std::string, int> &arities;
+    const std::unordered_map<std::string, int> &capacities;
+    const SharedChannelMap &channels;
+    Scheduler &scheduler;
+    ChannelMetricsMap *localMetrics;
+    OptLevel optLevel;
+    std::vector<TACInstruction> tac;
+    std::vector<std::string> receives; // canais em que o ramo recebe (assinante dos de difusão)
+    std::unique_ptr<TACInterpreter> interpreter;
+};
+
+// Canais compartilhados pelos ramos de PAR, com a capacidade declarada (sem limite se não houver),
+// escolhidos pela topologia estática (analyze_channel_topology): canal de um único ramo fica fora do mapa e
+// usa a fila local do interpretador, sem sincronização; SPSC usa o anel lock-free de produtor e consumidor
+// únicos; MPSC, SPMC e MPMC usam a fila MPMC (não há fila especializada para um só lado múltiplo).
+// Canal `broadcast` com mais de um ramo recebendo usa o anel de difusão (uma escrita, cursor por ramo).
+static SharedChannelMap make_shared_channels(ProgramNode *prog, const std::unordered_map<std::string, int> &arities,
+                                             const std::unordered_map<std::string, ChannelTopologyInfo> &topology,
+                                             const std::unordered_map<std::string, ChannelWaitPolicy> &policies)
+{
+    std::unordered_map<std::string, const ChannelDeclNode *> decls;
+    for (auto &st : prog->statements)
+        if (auto decl = dynamic_cast<ChannelDeclNode *>(st.get()))
+            decls[decl->name] = decl;
+    SharedChannelMap channels;
+    for (auto &entry : topology)
+    {
+        const std::string &name = entry.first;
+        if (entry.second.topology == ChannelTopology::LOCAL)
+            continue;
+        auto decl = decls.find(name);
+        ChannelKind kind = entry.second.topology == ChannelTopology::SPSC ? ChannelKind::SPSC : ChannelKind::MPMC;
+        if (decl != decls.end() && decl->second->broadcast && entry.second.consumers > 1)
+            kind = ChannelKind::BROADCAST;
+        size_t capacity = decl != decls.end() && decl->second->capacity > 0 ? (size_t)decl->second->capacity : 0;
+        auto arity = arities.find(name);
+        channels[name].reset(new SharedChannel(kind, (size_t)std::max(arity == arities.end() ? 0 : arity->second, 1),
+                                               capacity));
+        auto policy = policies.find(name);
+        if (policy == policies.end())
+            policy = policies.find("*");
+        if (policy != policies.end())
+            channels[name]->setWaitPolicy(policy->second);
+    }
+    return channels;
+}
+
+// Início de bloco PAR: os assinantes de cada canal de difusão são os ramos do bloco que recebem nele
+static void begin_broadcast_block(ParNode *par, SharedChannelMap &channels)
+{
+    auto subscribers = channel_subscribers(par);
+    for (auto &entry : channels)
+        if (entry.second->broadcast())
+        {
+            auto it = subscribers.find(entry.first);
+            entry.second->beginBroadcast(it == subscribers.end() ? 0 : (size_t)it->second);
+        }
+}
+
+// --channel-wait=<canal|*>:<giros>:<cessões> (o nome * vale para todos os canais sem ajuste próprio)
+static bool parse_channel_wait(const std::string &spec, std::unordered_map<std::string, ChannelWaitPolicy> &policies)
+{
+    size_t a = spec.find(':'), b = a == std::string::npos ? a : spec.find(':', a + 1);
+    if (b == std::string::npos || a == 0)
+        return false;
+    ChannelWaitPolicy policy;
+    policy.spins = (unsigned)std::strtoul(spec.substr(a + 1, b - a - 1).c_str(), nullptr, 10);
+    policy.yields = (unsigned)std::strtoul(spec.substr(b + 1).c_str(), nullptr, 10);
+    policies[spec.substr(0, a)] = policy;
+    return true;
+}
+
+static const char *channel_kind_name(const SharedChannel &ch)
+{
+    if (ch.endpoint())
+        return ch.endpoint()->transport();
+    switch (ch.kind())
+    {
+    case ChannelKind::SPSC:
+        return "SPSC";
+    case ChannelKind::BROADCAST:
+        return "BROADCAST";
+    default:
+        return "MPMC";
+    }
+}
+
+// Acumuladores das filas locais (canais de um único ramo), um por canal do programa
+static ChannelMetricsMap make_local_metrics(const std::unordered_map<std::string, int> &arities)
+{
+    ChannelMetricsMap metrics;
+    for (const auto &entry : arities)
+        metrics[entry.first].reset(new ChannelMetrics());
+    return metrics;
+}
+
+// Métricas por canal ao fim da execução: canais compartilhados e filas locais que tiveram tráfego
+static void print_metrics_report(const SharedChannelMap &shared, const ChannelMetricsMap &local, MetricsFormat format,
+                                 const std::string &component, std::ostream &out)
+{
+    std::vector<ChannelMetricsRow> rows;
+    for (const auto &entry : shared)
+        rows.push_back(ChannelMetricsRow{entry.first, channel_kind_name(*entry.second), &entry.second->metrics()});
+    for (const auto &entry : local)
+        if (!shared.count(entry.first) && (entry.second->sent.load() || entry.second->received.load()))
+            rows.push_back(ChannelMetricsRow{entry.first, "LOCAL", entry.second.get()});
+    print_channel_metrics(rows, format, component, out);
+}
+
+static void print_channel_stats(const SharedChannelMap &channels,
+                                const std::unordered_map<std::string, ChannelTopologyInfo> &topology, std::ostream &out)
+{
+    std::vector<std::string> names;
+    for (auto &entry : channels)
+        names.push_back(entry.first);
+    std::sort(names.begin(), names.end());
+    for (const auto &name : names)
+    {
+        const SharedChannel &ch = *channels.at(name);
+        const ChannelWaitStats &st = ch.stats();
+        unsigned long long wakes = st.wakes.load();
+        out << "channel " << name << " kind=" << channel_kind_name(ch)
+            << " topology=" << channel_topology_name(topology.at(name).topology)
+            << " policy=" << ch.policy().spins << ":" << ch.policy().yields
+            << " spins=" << st.spins.load() << " spin_hits=" << st.spinHits.load()
+            << " yields=" << st.yields.load() << " parks=" << st.parks.load();
+        if (ch.remote())
+            out << " polls=" << st.polls.load();
+        if (ch.broadcast())
+            out << " subscribers=" << ch.subscribers();
+        out << " wakes=" << wakes
+            << " avg_wake_us=" << std::fixed << std::setprecision(2)
+            << (wakes ? (double)st.wakeLatencyNs.load() / wakes / 1000.0 : 0.0);
+        if (ch.endpoint() && ch.endpoint()->oversized())
+            out << " oversized=" << ch.endpoint()->oversized();
+        out << "\n";
+    }
+}
+
+// Modo --processes: os ramos de cada bloco PAR rodam agrupados por componente (`comp`), um processo por
+// componente. Canais entre componentes usam anéis em memória compartilhada ou sockets Unix
+// (ComponentChannels, conforme --transport); os demais canais compartilhados são criados dentro de cada
+// processo e, ao contrário dos anéis, não sobrevivem ao bloco. O processo pai só cria os canais entre
+// componentes, espera os filhos e imprime as saídas na ordem dos ramos.
+static bool run_par_processes(ProgramNode *prog, const std::unordered_map<std::string, int> &arities,
+                              const std::unordered_map<std::string, int> &capacities,
+                              const std::unordered_map<std::string, ChannelWaitPolicy> &policies,
+                              ChannelTransport transport, bool pinCores, bool verbose, bool runtimeStats,
+                              MetricsFormat metricsFormat, OptLevel optLevel)
+{
+    ComponentLayout layout = analyze_components(prog);
+    for (const auto &error : layout.errors)
+        std::cerr << "[erro] --processes: " << error << "\n";
+    if (!layout.errors.empty())
+        return false;
+    auto topology = analyze_channel_topology(prog);
+    ComponentChannels cross(layout, capacities, transport);
+    if (!layout.channels.empty() && !cross.valid())
+    {
+        std::cerr << (transport == ChannelTransport::SHM ? "[erro] --processes: memória compartilhada indisponível\n"
+                                                         : "[erro] --processes: sockets Unix indisponíveis\n");
+        return false;
+    }
+    bool ok = true;
+    std::vector<std::string> reports;
+    std::vector<std::string> reportOwners;
+    for (auto &st : prog->statements)
+    {
+        auto par = dynamic_cast<ParNode *>(st.get());
+        if (!par)
+            continue;
+        std::vector<SeqNode *> seqs;
+        std::vector<ComponentJob> jobs;
+        for (auto &seqPtr : par->statements)
+            if (auto seq = dynamic_cast<SeqNode *>(seqPtr.get()))
+            {
+                std::string comp = branch_component(seq);
+                auto job = std::find_if(jobs.begin(), jobs.end(), [&](const ComponentJob &j)
+                                        { return j.component == comp; });
+                if (job == jobs.end())
+                    job = jobs.insert(jobs.end(), ComponentJob{comp, {}});
+                job->branches.push_back(seqs.size());
+                seqs.push_back(seq);
+            }
+        std::vector<std::string> running;
+        for (const auto &job : jobs)
+            running.push_back(job.component);
+        cross.beginBlock(running);
+        auto body = [&](const ComponentJob &job, std::vector<std::string> &outputs, std::string &report)
+        {
+            SharedChannelMap channels = make_shared_channels(prog, arities, topology, policies);
+            cross.attach(job.component, arities, channels);
+            begin_broadcast_block(par, channels);
+            ChannelMetricsMap localMetrics = make_local_metrics(arities);
+            Scheduler scheduler;
+            std::vector<std::unique_ptr<SeqTask>> branches;
+            std::vector<GreenTask *> tasks;
+            for (size_t idx : job.branches)
+            {
+                branches.emplace_back(new SeqTask(seqs[idx], arities, capacities, channels, scheduler,
+                                                  runtimeStats || verbose ? &localMetrics : nullptr, optLevel));
+                tasks.push_back(branches.back().get());
+            }
+            scheduler.runAll(tasks);
+            // Todos os processos param de receber antes de esperar a entrega dos próprios lotes (na
+            // destruição do mapa): dois componentes esperando um pelo outro não travam
+            for (auto &entry : channels)
+                entry.second->finish();
+            bool ok = true;
+            for (size_t k = 0; k < branches.size(); ++k)
+            {
+                outputs.push_back(branches[k]->out.str());
+                if (!branches[k]->error.empty())
+                {
+                    std::cerr << "[erro] ramo " << job.branches[k] << ": " << branches[k]->error << "\n";
+                    ok = false;
+                }
+            }
+            if (runtimeStats || verbose)
+            {
+                std::ostringstream stats;
+                print_channel_stats(channels, topology, stats);
+                print_metrics_report(channels, localMetrics, metricsFormat, job.component.empty() ? "-" : job.component,
+                                     stats);
+                report = stats.str();
+            }
+            return ok;
+        };
+        std::vector<std::string> outputs, blockReports;
+        // Nada pendente no buffer de saída, senão cada filho o herdaria e imprimiria de novo
+        std::cout.flush();
+        ok = run_component_processes(jobs, seqs.size(), body, [&](const ComponentJob &job)
+                                     { cross.markGone(job.component); }, pinCores, outputs, blockReports, std::cerr) &&
+             ok;
+        for (size_t idx = 0; idx < outputs.size(); ++idx)
+        {
+            if (verbose)
+                std::cout << "[THREAD " << idx << "]\n";
+            std::cout << outputs[idx];
+        }
+        for (size_t j = 0; j < jobs.size(); ++j)
+        {
+            reportOwners.push_back(jobs[j].component);
+            reports.push_back(blockReports[j]);
+        }
+    }
+    if (runtimeStats || verbose)
+    {
+        std::cout << "\n=== RUNTIME STATS ===\n";
+        for (size_t k = 0; k < reports.size(); ++k)
+            std::cout << "component " << (reportOwners[k].empty() ? "-" : reportOwners[k]) << "\n" << reports[k];
+    }
+    return ok;
+}
+
 static std::string timestamp_iso_utc()
 {
     auto now = std::chrono::system_clock::now();
@@ -52,6 +386,9 @@ static std::string token_category(TokenType t)
     case TokenType::WHILE:
     case TokenType::PRINT:
     case TokenType::INPUT:
+    case TokenType::SELECT:
+    case TokenType::BROADCAST:
+    case TokenType::GLOBAL:
         return "KEYWORD";
     case TokenType::IDENTIFIER:
         return "IDENTIFIER";
@@ -87,12 +424,56 @@ static std::string token_category(TokenType t)
 
 int main(int argc, char *argv[])
 {
-    if (argc < 2 || argc > 3)
+    bool verbose = false;
+    bool runtimeStats = false;
+    MetricsFormat metricsFormat = MetricsFormat::TABLE;
+    bool channelFusion = true;
+    bool processMode = false;
+    bool pinCores = false;
+    OptLevel optLevel = OptLevel::O0;
+    bool optReport = false;
+    ChannelTransport transport = ChannelTransport::SHM;
+    std::unordered_map<std::string, ChannelWaitPolicy> waitPolicies;
+    bool usageError = argc < 2;
+    for (int k = 2; k < argc && !usageError; ++k)
     {
-        std::cout << "Uso: " << argv[0] << " <arquivo.minipar> [--verbose|-v]\n";
+        std::string arg = argv[k];
+        if (arg == "--verbose" || arg == "-v")
+            verbose = true;
+        else if (arg == "--runtime-stats")
+            runtimeStats = true;
+        else if (arg == "--channel-metrics" || arg == "--channel-metrics=table" || arg == "--channel-metrics=json")
+        {
+            runtimeStats = true;
+            metricsFormat = arg == "--channel-metrics=json" ? MetricsFormat::JSON : MetricsFormat::TABLE;
+        }
+        else if (arg == "--no-fusion")
+            channelFusion = false;
+        else if (arg == "--processes")
+            processMode = true;
+        else if (arg == "--pin-cores")
+            processMode = pinCores = true;
+        else if (arg == "--transport=shm" || arg == "--transport=socket")
+        {
+            processMode = true;
+            transport = arg == "--transport=shm" ? ChannelTransport::SHM : ChannelTransport::SOCKET;
+        }
+        else if (arg.compare(0, 2, "-O") == 0)
+            usageError = !parse_opt_level(arg, optLevel);
+        else if (arg == "--opt-report")
+            optReport = true;
+        else if (arg.compare(0, 15, "--channel-wait=") == 0)
+            usageError = !parse_channel_wait(arg.substr(15), waitPolicies);
+        else
+            usageError = true;
+    }
+    if (usageError)
+    {
+        std::cout << "Uso: " << argv[0]
+                  << " <arquivo.minipar> [--verbose|-v] [-O0|-O1|-O2] [--opt-report] [--runtime-stats] [--channel-metrics[=table|json]] [--no-fusion] [--processes] [--pin-cores]"
+                  << " [--transport=shm|socket] [--channel-wait=<canal|*>:<giros>:<cessões>]\n";
         return 1;
     }
-    bool verbose = (argc == 3) && (std::string(argv[2]) == "--verbose" || std::string(argv[2]) == "-v");
 
     std::string source_code = read_file(argv[1]);
     if (source_code.empty())
@@ -119,7 +500,9 @@ int main(int argc, char *argv[])
 
     Parser parser(tokens);
     auto ast = parser.parse();
-    bool success = ast != nullptr;
+    for (const auto &error : parser.errors())
+        std::cerr << "[erro] " << error << "\n";
+    bool success = ast != nullptr && parser.errors().empty();
     if (verbose)
     {
         std::cout << "\n=== SYNTAX ===\nstatus: " << (success ? "SUCCESS" : "ERROR") << "\n";
@@ -168,10 +551,19 @@ int main(int argc, char *argv[])
 
     std::vector<TACInstruction> tac;        // TAC principal
     std::vector<TACInstruction> tacForExec; // reservado se precisar filtrar
+    PassManager passes(optLevel);
     if (success)
     {
         TACGenerator gen;
         tac = gen.generate(static_cast<ProgramNode *>(ast.get()));
+        // Interpretador e ARMGenerator recebem o TAC otimizado (ramos de PAR são otimizados em SeqTask)
+        passes.run(tac);
+    }
+    if ((verbose || optReport) && success)
+    {
+        std::cout << "\n=== OPTIMIZATION ===\n";
+        std::cout << "level: -O" << (int)optLevel << "\n";
+        print_pass_stats(passes.stats(), std::cout);
     }
     if (verbose)
     {
@@ -188,19 +580,20 @@ int main(int argc, char *argv[])
                 opType = "CONDITIONAL_JUMP";
             else if (i.op == "goto")
                 opType = "JUMP";
-            else if (i.op == "send")
+            else if (i.op == "send_msg")
                 opType = "CHANNEL_SEND";
-            else if (i.op == "send_arg")
-                opType = "CHANNEL_SEND_ARG";
-            else if (i.op == "receive")
+            else if (i.op == "recv_msg" || i.op == "take_msg")
                 opType = "CHANNEL_RECEIVE";
-            else if (i.op == "recv_arg")
-                opType = "CHANNEL_RECV_ARG";
+            else if (i.op == "select_msg")
+                opType = "CHANNEL_SELECT";
             else if (i.op.empty())
                 opType = "ASSIGN";
             else
                 opType = "BINARY";
-            std::cout << i.result << " = (" << i.op << ") " << i.arg1 << (i.arg2.empty() ? "" : " , ") << i.arg2 << " | type=" << opType << "\n";
+            std::cout << i.result << " = (" << i.op << ") " << i.arg1 << (i.arg2.empty() ? "" : " , ") << i.arg2;
+            for (const auto &a : i.args)
+                std::cout << " , " << a;
+            std::cout << " | type=" << opType << "\n";
         }
     }
 
@@ -228,41 +621,100 @@ int main(int argc, char *argv[])
                 }
             }
         }
+        // Filas de canal dimensionadas pela aridade de mensagem de cada canal
+        auto arities = channel_message_arities(static_cast<ProgramNode *>(ast.get()));
+        auto capacities = channel_capacities(static_cast<ProgramNode *>(ast.get()));
         std::cout << "\n=== PROGRAM OUTPUT ===\n";
         if (!hasPar)
         {
             TACInterpreter interpreter;
+            interpreter.setChannelArities(arities);
+            interpreter.setChannelCapacities(capacities);
+            interpreter.setChannelMetrics(runtimeStats || verbose);
             std::stringstream runtimeOut;
             auto finalEnv = interpreter.interpret(tac, runtimeOut);
             std::cout << runtimeOut.str();
+            if (!interpreter.error().empty())
+            {
+                std::cerr << "[erro] " << interpreter.error() << "\n";
+                success = false;
+            }
+            if (runtimeStats || verbose)
+            {
+                // Programa sequencial: só filas locais
+                ChannelMetricsMap localMetrics = make_local_metrics(arities);
+                for (const auto &entry : interpreter.localChannels())
+                {
+                    auto total = localMetrics.find(entry.first);
+                    if (total != localMetrics.end())
+                        total->second->merge(entry.second.metrics);
+                }
+                std::cout << "\n=== RUNTIME STATS ===\n";
+                print_metrics_report(SharedChannelMap(), localMetrics, metricsFormat, "", std::cout);
+            }
         }
         else
         {
-            // Executa blocos PAR seq a seq (simplificação) para saída determinística em modo não-verbose
-            if (auto prog = static_cast<ProgramNode *>(ast.get()))
+            // Ramos SEQ de cada bloco PAR viram tarefas leves do escalonador M:N (join ao fim do bloco).
+            // Cada ramo tem interpretador e saída próprios; as saídas são impressas na ordem dos ramos.
+            // Canais declarados são filas lock-free compartilhadas entre os ramos e entre blocos PAR.
+            auto broadcastErrors = broadcast_channel_errors(static_cast<ProgramNode *>(ast.get()));
+            for (const auto &error : broadcastErrors)
+                std::cerr << "[erro] " << error << "\n";
+            if (!broadcastErrors.empty())
+                success = false;
+            else if (processMode)
+                success = run_par_processes(static_cast<ProgramNode *>(ast.get()), arities, capacities, waitPolicies,
+                                            transport, pinCores, verbose, runtimeStats, metricsFormat, optLevel);
+            else if (auto prog = static_cast<ProgramNode *>(ast.get()))
             {
+                // Pares produtor/consumidor 1:1 viram um só ramo antes da análise de topologia (canal local)
+                std::vector<FusedChannel> fused;
+                if (channelFusion)
+                    fused = fuse_channel_pairs(prog);
+                auto topology = analyze_channel_topology(prog);
+                SharedChannelMap channels = make_shared_channels(prog, arities, topology, waitPolicies);
+                ChannelMetricsMap localMetrics = make_local_metrics(arities);
                 for (auto &st : prog->statements)
                 {
                     if (auto par = dynamic_cast<ParNode *>(st.get()))
                     {
-                        size_t idx = 0;
+                        begin_broadcast_block(par, channels);
+                        Scheduler scheduler;
+                        std::vector<std::unique_ptr<SeqTask>> branches;
+                        std::vector<GreenTask *> tasks;
                         for (auto &seqPtr : par->statements)
-                        {
                             if (auto seq = dynamic_cast<SeqNode *>(seqPtr.get()))
                             {
-                                TACGenerator localGen;
-                                auto localTAC = localGen.generate_from_seq(seq);
-                                TACInterpreter interpreter;
-                                std::stringstream thOut;
-                                interpreter.interpret(localTAC, thOut);
-                                if (verbose)
-                                    std::cout << "[THREAD " << idx << "]\n";
-                                std::cout << thOut.str();
-                                idx++;
+                                branches.emplace_back(new SeqTask(seq, arities, capacities, channels, scheduler,
+                                                                  runtimeStats || verbose ? &localMetrics : nullptr,
+                                                                  optLevel));
+                                tasks.push_back(branches.back().get());
                             }
+                        scheduler.runAll(tasks);
+                        for (size_t idx = 0; idx < branches.size(); ++idx)
+                        {
+                            if (verbose)
+                                std::cout << "[THREAD " << idx << "]\n";
+                            std::cout << branches[idx]->out.str();
                         }
+                        for (size_t idx = 0; idx < branches.size(); ++idx)
+                            if (!branches[idx]->error.empty())
+                            {
+                                std::cerr << "[erro] ramo " << idx << ": " << branches[idx]->error << "\n";
+                                success = false;
+                            }
                     }
                 }
+                if (runtimeStats || verbose)
+                {
+                    std::cout << "\n=== RUNTIME STATS ===\n";
+                    print_channel_stats(channels, topology, std::cout);
+                    for (const auto &f : fused)
+                        std::cout << "channel " << f.channel << " fused par=" << f.par << " producer=" << f.producer
+                                  << " consumer=" << f.consumer << "\n";
+                    print_metrics_report(channels, localMetrics, metricsFormat, "", std::cout);
+                }
             }
         }
     }
@@ -0,0 +1,24 @@
+#include "frame_arena.h"
+
+FrameArena::FrameArena(size_t chunkValues) : chunkValues(chunkValues) {}
+
+Value *FrameArena::push(size_t n, Mark &saved)
+{
+    saved = {cur, top};
+    if (chunks.empty())
+        chunks.push_back({std::unique_ptr<Value[]>(new Value[chunkValues]), chunkValues});
+    // Frame nunca atravessa blocos: se não cabe, avança para o próximo (alocando se preciso)
+    while (top + n > chunks[cur].size)
+    {
+        ++cur;
+        top = 0;
+        if (cur == chunks.size())
+        {
+            size_t size = n > chunkValues ? n : chunkValues;
+            chunks.push_back({std::unique_ptr<Value[]>(new Value[size]), size});
+        }
+    }
+    Value *base = chunks[cur].data.get() + top;
+    top += n;
+    return base;
+}
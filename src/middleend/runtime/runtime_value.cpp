@@ -0,0 +1,83 @@
+#include "runtime_value.h"
+#include <mutex>
+#include <unordered_set>
+
+static_assert(sizeof(Value) == 16, "Value deve caber em 16 bytes");
+
+const std::string *intern_string(const std::string &text)
+{
+    // Nós de unordered_set não mudam de endereço em rehash, então o ponteiro serve de handle
+    static std::mutex mtx;
+    static std::unordered_set<std::string> pool;
+    std::lock_guard<std::mutex> lock(mtx);
+    return &*pool.insert(text).first;
+}
+
+Value copy_value(const Value &v)
+{
+    if (v.tag == Value::ARRAY)
+        v.a->refs.fetch_add(1, std::memory_order_relaxed);
+    return v;
+}
+
+void release_value(Value &v)
+{
+    if (v.tag == Value::ARRAY && v.a->refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    {
+        for (auto &e : v.a->elems)
+            release_value(e);
+        delete v.a;
+    }
+    v = Value();
+}
+
+ArrayObj *unshare_array(Value &v)
+{
+    if (v.a->refs.load(std::memory_order_acquire) == 1)
+        return v.a;
+    // Compartilhado: cópia rasa, com os elementos (inclusive subarrays) ganhando uma referência
+    ArrayObj *dup = new ArrayObj();
+    dup->elems.reserve(v.a->elems.size());
+    for (const auto &e : v.a->elems)
+        dup->elems.push_back(copy_value(e));
+    release_value(v);
+    v = Value::ofArray(dup);
+    return dup;
+}
+
+void print_value(std::ostream &out, const Value &v)
+{
+    switch (v.tag)
+    {
+    case Value::INT:
+        out << v.i;
+        break;
+    case Value::FLOAT:
+        out << v.f;
+        break;
+    case Value::STR:
+        out << *v.s;
+        break;
+    case Value::ARRAY:
+    {
+        const auto &elems = v.a->elems;
+        out << "[";
+        for (size_t k = 0; k < elems.size(); ++k)
+        {
+            const Value &e = elems[k];
+            if (e.tag == Value::FLOAT && e.f == (int)e.f)
+                out << (int)e.f;
+            else if (e.tag == Value::NONE)
+                out << 0;
+            else
+                print_value(out, e);
+            if (k + 1 < elems.size())
+                out << ", ";
+        }
+        out << "]";
+        break;
+    }
+    default:
+        break;
+    }
+}
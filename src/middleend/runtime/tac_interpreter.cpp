@@ -1,6 +1,9 @@
 #include "tac_interpreter.h"
+#include <algorithm>
 #include <cstdlib>
 #include <iostream>
+#include <tuple>
+#include <unordered_set>
 #ifdef MINIPAR_DEBUG
 #define DBG(msg)          \
     do                    \
@@ -14,652 +17,1383 @@
     } while (0)
 #endif
 
-double TACInterpreter::valueOf(const std::string &token) const
+int TACInterpreter::intern(const std::string &name)
 {
-    if (token.empty())
-        return 0.0;
+    if (name.empty())
+        return -1;
+    auto it = slotOf.find(name);
+    if (it != slotOf.end())
+        return it->second;
+    int slot = (int)slotNames.size();
+    slotOf.emplace(name, slot);
+    slotNames.push_back(name);
+    return slot;
+}
 
-    // Prioriza variáveis locais (pode ser int ou float)
-    auto it_f = envF.find(token);
-    if (it_f != envF.end())
-        return it_f->second;
+TACOp decode_tac_op(const std::string &op)
+{
+    static const std::unordered_map<std::string, TACOp> table = {
+        {"=", TACOp::ASSIGN},
+        {"+", TACOp::ADD},
+        {"-", TACOp::SUB},
+        {"*", TACOp::MUL},
+        {"/", TACOp::DIV},
+        {"==", TACOp::EQ},
+        {"!=", TACOp::NE},
+        {"<", TACOp::LT},
+        {"<=", TACOp::LE},
+        {">", TACOp::GT},
+        {">=", TACOp::GE},
+        {"&&", TACOp::AND},
+        {"||", TACOp::OR},
+        {"!", TACOp::NOT},
+        {"print", TACOp::PRINT},
+        {"print_last", TACOp::PRINT_LAST},
+        {"label", TACOp::LABEL},
+        {"if_false", TACOp::IF_FALSE},
+        {"goto", TACOp::GOTO},
+        {"param", TACOp::PARAM},
+        {"array_concat", TACOp::ARRAY_CONCAT},
+        {"call", TACOp::CALL},
+        {"return", TACOp::RETURN},
+        {"send_msg", TACOp::SEND_MSG},
+        {"recv_msg", TACOp::RECV_MSG},
+        {"select_msg", TACOp::SELECT_MSG},
+        {"take_msg", TACOp::TAKE_MSG},
+        {"array_init", TACOp::ARRAY_INIT},
+        {"array_set", TACOp::ARRAY_SET},
+        {"array_get", TACOp::ARRAY_GET},
+    };
+    auto it = table.find(op);
+    return it != table.end() ? it->second : TACOp::NOP;
+}
 
-    auto it_i = env.find(token);
-    if (it_i != env.end())
-        return (double)it_i->second;
+// Leitura literal de um token: inteiro, float ou string crua
+static Value literal_value(const std::string &token)
+{
+    char *end = nullptr;
+    long v = std::strtol(token.c_str(), &end, 10);
+    if (*end == '\0')
+        return Value::ofInt((int)v);
+    char *endf = nullptr;
+    double vf = std::strtod(token.c_str(), &endf);
+    if (*endf == '\0')
+        return Value::ofFloat(vf);
+    return Value::ofStr(intern_string(token));
+}
 
-    // Se não for variável, tenta converter para número literal
-    char *end_i = nullptr;
-    long v_i = std::strtol(token.c_str(), &end_i, 10);
+// Operações cujo campo result é um nome escrito (nas demais é canal, label ou array indexado)
+static bool writes_result(TACOp op)
+{
+    switch (op)
+    {
+    case TACOp::ARRAY_SET:
+    case TACOp::PRINT:
+    case TACOp::PRINT_LAST:
+    case TACOp::LABEL:
+    case TACOp::IF_FALSE:
+    case TACOp::GOTO:
+    case TACOp::RETURN:
+    case TACOp::SEND_MSG:
+    case TACOp::RECV_MSG: // escreve os operandos da lista, não result
+    case TACOp::TAKE_MSG:
+    case TACOp::NOP:
+        return false;
+    default:
+        return true;
+    }
+}
 
-    char *end_f = nullptr;
-    double v_f = std::strtod(token.c_str(), &end_f);
+// Operações que escrevem as variáveis da lista de operandos
+static bool writes_list(TACOp op)
+{
+    return op == TACOp::RECV_MSG || op == TACOp::TAKE_MSG;
+}
 
-    // Se o token inteiro foi consumido na conversão para float, é um float.
-    if (*end_f == '\0')
+// Nomes da convenção de chamada do gerador (retval, arg0, arg1, ...) são globais
+static bool is_calling_convention(const std::string &name)
+{
+    if (name == "retval")
+        return true;
+    if (name.size() < 4 || name.compare(0, 3, "arg") != 0)
+        return false;
+    return name.find_first_not_of("0123456789", 3) == std::string::npos;
+}
+
+void TACInterpreter::load(const std::vector<TACInstruction> &instrs)
+{
+    // Internação: todo token de operando vira slot; literais recebem slot que nunca é definido
+    slotOf.clear();
+    slotNames.clear();
+    code.assign(instrs.size(), DecodedInstr());
+    operandLists.clear();
+    std::unordered_map<std::string, int> labelMap;
+    for (size_t i = 0; i < instrs.size(); ++i)
     {
-        return v_f;
+        code[i].op = decode_tac_op(instrs[i].op);
+        code[i].result = intern(instrs[i].result);
+        code[i].arg1 = intern(instrs[i].arg1);
+        code[i].arg2 = intern(instrs[i].arg2);
+        // Lista de select_msg é de canais, não de operandos (lida de args na execução)
+        if (!instrs[i].args.empty() && code[i].op != TACOp::SELECT_MSG)
+        {
+            code[i].list = (int)operandLists.size();
+            code[i].count = (int)instrs[i].args.size();
+            for (const auto &a : instrs[i].args)
+                operandLists.push_back(intern(a));
+        }
+        if (code[i].op == TACOp::LABEL)
+            labelMap[instrs[i].result] = (int)i;
     }
-    // Senão, se foi consumido na conversão para int, é um int.
-    if (*end_i == '\0')
+    // Resolve destinos de salto: execução continua logo após o label
+    for (size_t i = 0; i < instrs.size(); ++i)
+    {
+        const std::string *label = nullptr;
+        if (code[i].op == TACOp::GOTO || code[i].op == TACOp::CALL)
+            label = &instrs[i].arg1;
+        else if (code[i].op == TACOp::IF_FALSE)
+            label = &instrs[i].arg2;
+        if (!label)
+            continue;
+        auto it = labelMap.find(*label);
+        if (it != labelMap.end())
+            code[i].target = it->second + 1;
+    }
+    // Pool de constantes e classificação: token escrito por alguma instrução é variável, os demais são constantes
+    constants.assign(slotNames.size(), Value());
+    constantSlot.assign(slotNames.size(), true);
+    for (size_t s = 0; s < slotNames.size(); ++s)
+        constants[s] = literal_value(slotNames[s]);
+    for (size_t i = 0; i < instrs.size(); ++i)
     {
-        return (double)v_i;
+        if (writes_result(code[i].op) && code[i].result >= 0)
+            constantSlot[code[i].result] = false;
+        if (writes_list(code[i].op))
+            for (int k = 0; k < code[i].count; ++k)
+                constantSlot[operandLists[code[i].list + k]] = false;
     }
+    fuseAppends();
+    releaseSlots();
+    loadFunctions(instrs);
+    markMovableSends();
+    selectTurn.assign(code.size(), 0);
+    slots.assign(slotNames.size(), Value());
+    for (size_t s = 0; s < slotNames.size(); ++s)
+        if (constantSlot[s])
+            slots[s] = constants[s];
+    auto lookup = [&](const char *name)
+    {
+        auto it = slotOf.find(name);
+        return it != slotOf.end() ? it->second : -1;
+    };
+    slotOperacao = lookup("operacao");
+    slotValor1 = lookup("valor1");
+    slotValor2 = lookup("valor2");
+    slotResultado = lookup("resultado");
+}
 
-    return 0.0; // Default se não for nem var nem literal numérico
+void TACInterpreter::fuseAppends()
+{
+    // Lista crescendo em laço (`x = x + [e]`) vira `t = x + tE; x = t`: sem fusão, cada passo copia x inteiro.
+    // Se t não é lido em nenhum outro lugar, a dupla vira array_append, que estende x no próprio lugar.
+    std::vector<int> reads(slotNames.size(), 0);
+    for (const auto &d : code)
+    {
+        if (d.arg1 >= 0)
+            ++reads[d.arg1];
+        if (d.arg2 >= 0)
+            ++reads[d.arg2];
+        if (d.op == TACOp::SEND_MSG)
+            for (int k = 0; k < d.count; ++k)
+                ++reads[operandLists[d.list + k]];
+    }
+    for (size_t i = 0; i < code.size(); ++i)
+    {
+        DecodedInstr &cat = code[i];
+        if ((cat.op != TACOp::ADD && cat.op != TACOp::ARRAY_CONCAT) || cat.result < 0 || cat.arg1 < 0)
+            continue;
+        // Sem o temporário (propagação de cópias do otimizador): a própria instrução estende x
+        if (cat.result == cat.arg1)
+        {
+            cat.fused = cat.op;
+            cat.op = TACOp::ARRAY_APPEND;
+            cat.inPlace = true;
+            continue;
+        }
+        if (i + 1 == code.size())
+            continue;
+        const DecodedInstr &copy = code[i + 1];
+        if (copy.op != TACOp::ASSIGN || copy.arg1 != cat.result || copy.result != cat.arg1 || reads[cat.result] != 1)
+            continue;
+        cat.fused = cat.op;
+        cat.op = TACOp::ARRAY_APPEND;
+    }
 }
 
-void TACInterpreter::finalizeSend()
+void TACInterpreter::loadFunctions(const std::vector<TACInstruction> &instrs)
 {
-    if (!buildingChannel.empty() && buildingMessage.size() == expectedSendArgs)
+    // O gerador emite cada função como `label f; param...; corpo; label L_return_f; return retval`, e todo
+    // call aponta para logo após o label f: o corpo vai do destino do call até o return que segue o label
+    // de retorno (sem ele, TAC escrito à mão, até o primeiro return).
+    functions.clear();
+    struct Body
+    {
+        size_t begin, end; // [begin, end], end no return final
+    };
+    std::vector<Body> bodies;
+    std::unordered_map<int, int> functionAt; // ip de entrada -> índice em functions
+    for (auto &call : code)
+    {
+        if (call.op != TACOp::CALL || call.target < 0)
+            continue;
+        auto known = functionAt.find(call.target);
+        if (known != functionAt.end())
+        {
+            call.func = known->second;
+            continue;
+        }
+        const std::string returnLabel = "L_return_" + (call.arg1 >= 0 ? slotNames[call.arg1] : std::string());
+        size_t end = (size_t)call.target;
+        while (end < code.size() && !(code[end].op == TACOp::LABEL && code[end].result >= 0 &&
+                                      slotNames[code[end].result] == returnLabel))
+            ++end;
+        if (end == code.size())
+            end = (size_t)call.target;
+        while (end < code.size() && code[end].op != TACOp::RETURN)
+            ++end;
+        call.func = (int)bodies.size();
+        functionAt.emplace(call.target, call.func);
+        bodies.push_back({(size_t)call.target, end});
+    }
+
+    for (size_t f = 0; f < bodies.size(); ++f)
     {
-        channels[buildingChannel].messages.push_back(buildingMessage);
+        FunctionInfo info;
+        std::unordered_map<int, int> localOf; // slot global -> deslocamento no frame
+        // Locais: todo nome escrito no corpo (parâmetros e temporários incluídos), menos a convenção de
+        // chamada e os declarados `global` no corpo. Cada chamada tem os seus, mesmo que o nome exista fora.
+        std::unordered_set<int> globals;
+        for (size_t i = bodies[f].begin; i < bodies[f].end; ++i)
+            if (instrs[i].op == "global" && code[i].result >= 0)
+                globals.insert(code[i].result);
+        auto addLocal = [&](int res)
+        {
+            if (res < 0 || res >= LOCAL_SLOT_BASE || is_calling_convention(slotNames[res]) || localOf.count(res) ||
+                globals.count(res))
+                return;
+            localOf.emplace(res, (int)info.localInit.size());
+            info.localInit.push_back(constants[res]);
+        };
+        for (size_t i = bodies[f].begin; i < bodies[f].end; ++i)
+        {
+            if (writes_result(code[i].op))
+                addLocal(code[i].result);
+            if (writes_list(code[i].op))
+                for (int k = 0; k < code[i].count; ++k)
+                    addLocal(operandLists[code[i].list + k]);
+        }
+        auto recode = [&](int &operandSlot)
+        {
+            auto it = operandSlot >= 0 ? localOf.find(operandSlot) : localOf.end();
+            if (it != localOf.end())
+                operandSlot = LOCAL_SLOT_BASE + it->second;
+        };
+        for (size_t i = bodies[f].begin; i <= bodies[f].end && i < code.size(); ++i)
+        {
+            recode(code[i].result);
+            recode(code[i].arg1);
+            recode(code[i].arg2);
+            for (int k = 0; k < code[i].count; ++k)
+                recode(operandLists[code[i].list + k]);
+        }
+        functions.push_back(std::move(info));
     }
-    buildingChannel.clear();
-    expectedSendArgs = 0;
-    buildingMessage.clear();
+    // Código de função alcançado sem call usa um frame raiz com o maior número de locais
+    size_t widest = 0;
+    for (const auto &f : functions)
+        widest = std::max(widest, f.localInit.size());
+    rootFrame.assign(widest, Value::ofInt(0));
+    fp = rootFrame.data();
 }
 
-void TACInterpreter::finalizeReceive()
+void TACInterpreter::markMovableSends()
 {
-    // após mapear todas as variáveis, podemos executar lógica de cálculo se presente
-    if (receivingChannel.empty() || receivedMessage.size() != expectedRecvArgs)
+    // Um operando de send_msg pode ser movido para a mensagem se (1) nenhuma outra instrução o lê e
+    // (2) ele é escrito antes, no mesmo bloco básico: toda nova execução do send passa por essa escrita,
+    // então o slot esvaziado pelo envio nunca é observado. Temporários de expressão caem sempre aqui.
+    moveOperand.assign(operandLists.size(), 0);
+    std::unordered_map<int, int> reads;
+    for (const auto &d : code)
     {
-        receivingChannel.clear();
-        expectedRecvArgs = 0;
-        receivedMessage.clear();
+        if (d.arg1 >= 0)
+            ++reads[d.arg1];
+        if (d.arg2 >= 0)
+            ++reads[d.arg2];
+        if (!writes_result(d.op) && d.op != TACOp::LABEL && d.result >= 0)
+            ++reads[d.result]; // array_set altera o array de result
+        if (d.op == TACOp::SEND_MSG)
+            for (int k = 0; k < d.count; ++k)
+                ++reads[operandLists[d.list + k]];
+    }
+    auto writes = [&](const DecodedInstr &d, int slot)
+    {
+        if (writes_result(d.op) && d.result == slot)
+            return true;
+        if (writes_list(d.op))
+            for (int k = 0; k < d.count; ++k)
+                if (operandLists[d.list + k] == slot)
+                    return true;
+        return false;
+    };
+    for (size_t i = 0; i < code.size(); ++i)
+    {
+        if (code[i].op != TACOp::SEND_MSG)
+            continue;
+        for (int k = 0; k < code[i].count; ++k)
+        {
+            int slot = operandLists[code[i].list + k];
+            if (slot < 0 || (slot < LOCAL_SLOT_BASE && constantSlot[slot]) || reads[slot] != 1)
+                continue;
+            for (size_t j = i; j-- > 0 && code[j].op != TACOp::LABEL;)
+                if (writes(code[j], slot))
+                {
+                    moveOperand[code[i].list + k] = 1;
+                    break;
+                }
+        }
+    }
+}
+
+void TACInterpreter::releaseMessage()
+{
+    for (auto &v : message)
+        release_value(v);
+    message.clear();
+    pendingSend = false;
+}
+
+TACInterpreter::~TACInterpreter()
+{
+    unwindFrames();
+    releaseSlots();
+    releaseMessage();
+}
+
+void TACInterpreter::releaseSlots()
+{
+    for (auto &v : slots)
+        release_value(v);
+    for (auto &v : rootFrame)
+        release_value(v);
+}
+
+void TACInterpreter::unwindFrames()
+{
+    while (!callStack.empty())
+    {
+        const CallFrame &frame = callStack.back();
+        for (size_t k = 0; k < frame.nlocals; ++k)
+            release_value(fp[k]);
+        fp = frame.caller_fp;
+        callStack.pop_back();
+    }
+    arena.reset();
+}
+
+void TACInterpreter::store(int slot, Value v)
+{
+    if (slot < 0)
+    {
+        release_value(v);
         return;
     }
-    // Heurística: se temos operacao, valor1, valor2, resultado -> calcula
-    if ((env.count("valor1") && env.count("valor2") && env.count("resultado")))
+    Value &dst = ref(slot);
+    release_value(dst);
+    dst = v;
+}
+
+Value TACInterpreter::resolve(int slot) const
+{
+    if (slot < 0)
+        return Value::ofInt(0);
+    return copy_value(operand(slot));
+}
+
+double TACInterpreter::valueOf(int slot) const
+{
+    if (slot < 0)
+        return 0.0;
+    // Strings e arrays valem 0
+    return operand(slot).number();
+}
+
+bool TACInterpreter::sendLocal(const std::string &name)
+{
+    ChannelRuntime &chan = channel(name);
+    if (!chan.messages.push(message.data(), message.size()))
     {
-        int a = env["valor1"], b = env["valor2"], res = env["resultado"];
-        // Primeiro tenta operação numérica codificada
-        if (env.count("operacao"))
+        // Fila local só é lida por este ramo: canal limitado cheio nunca terá vaga
+        runtimeError = "send em canal '" + name + "' cheio (capacidade " + std::to_string(channelCapacities[name]) +
+                       ") sem receptor concorrente";
+        releaseMessage();
+        return false;
+    }
+    message.clear();
+    if (meterChannels)
+        chan.metrics.onSend(chan.messages.size());
+    return true;
+}
+
+ChannelRuntime &TACInterpreter::channel(const std::string &name)
+{
+    auto it = channels.find(name);
+    if (it != channels.end())
+        return it->second;
+    // Fila criada com a aridade analisada e o limite declarado do canal
+    auto arity = channelArities.find(name);
+    auto capacity = channelCapacities.find(name);
+    MessageRing ring(arity != channelArities.end() ? (size_t)arity->second : 0, 16,
+                     capacity != channelCapacities.end() ? (size_t)capacity->second : 0);
+    return channels.emplace(std::piecewise_construct, std::forward_as_tuple(name), std::forward_as_tuple(std::move(ring)))
+        .first->second;
+}
+
+SharedChannel *TACInterpreter::sharedChannel(const std::string &name) const
+{
+    if (!shared)
+        return nullptr;
+    auto it = shared->find(name);
+    return it == shared->end() ? nullptr : it->second.get();
+}
+
+void TACInterpreter::endBlocked(SharedChannel *chan, bool forSpace)
+{
+    if (!blockedSince)
+        return;
+    if (chan)
+        (forSpace ? chan->metrics().sendBlocked : chan->metrics().recvBlocked).record(SharedChannel::nowNs() - blockedSince);
+    blockedSince = 0;
+}
+
+size_t TACInterpreter::subscribed(const SharedChannel *chan) const
+{
+    for (const auto &entry : subscriptions)
+        if (entry.first == chan)
+            return entry.second;
+    return 0;
+}
+
+size_t TACInterpreter::subscriber(SharedChannel *chan)
+{
+    if (!chan->broadcast())
+        return 0;
+    for (const auto &entry : subscriptions)
+        if (entry.first == chan)
+            return entry.second;
+    subscriptions.emplace_back(chan, chan->subscribe());
+    return subscriptions.back().second;
+}
+
+template <class Attempt>
+TACInterpreter::WaitStep TACInterpreter::waitShared(SharedChannel *chan, bool forSpace, Attempt attempt)
+{
+    const ChannelWaitPolicy &policy = chan->policy();
+    ChannelWaitStats &stats = chan->stats();
+    for (unsigned k = 0; k < policy.spins; ++k)
+    {
+        cpu_relax();
+        if (attempt())
         {
-            int op = env["operacao"]; // 1=+,2=-,3=*,4=/
-            switch (op)
-            {
-            case 1:
-                res = a + b;
-                break;
-            case 2:
-                res = a - b;
-                break;
-            case 3:
-                res = a * b;
-                break;
-            case 4:
-                res = (b != 0 ? a / b : 0);
-                break;
-            }
+            stats.spins.fetch_add(k + 1, std::memory_order_relaxed);
+            stats.spinHits.fetch_add(1, std::memory_order_relaxed);
+            waitYields = 0;
+            return WaitStep::DONE;
         }
-        // Se existe operacao string, sobrescreve
-        if (envStr.find("operacao") != envStr.end())
+    }
+    stats.spins.fetch_add(policy.spins, std::memory_order_relaxed);
+    if (waitYields < policy.yields)
+    {
+        ++waitYields;
+        stats.yields.fetch_add(1, std::memory_order_relaxed);
+        return WaitStep::YIELD;
+    }
+    waitYields = 0;
+    if (chan->remote())
+    {
+        // Não há quem notifique: o escalonador volta a tentar quando não tiver outra tarefa. Terminado o processo
+        // do outro lado, a espera é liberada como num impasse (a reexecução ainda tenta a fila uma última vez)
+        if (chan->peerGone(forSpace))
         {
-            const std::string &opStr = envStr["operacao"];
-            if (opStr == "+")
-                res = a + b;
-            else if (opStr == "-")
-                res = a - b;
-            else if (opStr == "*")
-                res = a * b;
-            else if (opStr == "/")
-                res = (b != 0 ? a / b : 0);
+            receiveReleased = true;
+            return WaitStep::YIELD;
         }
-        env["resultado"] = res;
+        stats.polls.fetch_add(1, std::memory_order_relaxed);
+        return WaitStep::POLL;
+    }
+    // Registra a espera antes de reconferir: quem mudar a fila em seguida verá o registro e avisará
+    chan->addWaiter();
+    if (attempt())
+    {
+        chan->removeWaiter();
+        return WaitStep::DONE;
     }
-    receivingChannel.clear();
-    expectedRecvArgs = 0;
-    receivedMessage.clear();
+    stats.parks.fetch_add(1, std::memory_order_relaxed);
+    waitingOn = chan;
+    waitingShared = chan;
+    waitingForSpace = forSpace;
+    parkedAt = SharedChannel::nowNs();
+    return WaitStep::PARK;
 }
 
-std::unordered_map<std::string, int> TACInterpreter::interpret(const std::vector<TACInstruction> &instrs, std::ostream &out)
+TACInterpreter::WaitStep TACInterpreter::sendShared(SharedChannel *chan, const std::string &name)
 {
-    env.clear();
-    envStr.clear();
-    channels.clear();
-    arrays.clear();
-    arraysStr.clear();
-    arraysNested.clear();
-    buildingChannel.clear();
-    receivingChannel.clear();
-    expectedSendArgs = 0;
-    expectedRecvArgs = 0;
-    buildingMessage.clear();
-    receivedMessage.clear();
-
-    // Mapa de labels para índices
-    std::unordered_map<std::string, size_t> labelMap;
-    for (size_t i = 0; i < instrs.size(); ++i)
+    auto attempt = [&]
+    { return chan->tryPush(message.data(), message.size()); };
+    bool sent = attempt();
+    if (!sent && blockingReceive && !receiveReleased)
     {
-        if (instrs[i].op == "label")
-            labelMap[instrs[i].result] = i;
+        if (meterChannels && !blockedSince)
+            blockedSince = SharedChannel::nowNs();
+        WaitStep step = waitShared(chan, true, attempt);
+        if (step != WaitStep::DONE)
+            return step;
+        sent = true;
     }
-    // Pré-pass: coletar params por função (param instruções seguem label)
-    for (size_t i = 0; i < instrs.size(); ++i)
+    // Enviada (valores agora pertencem ao canal) ou sem vaga possível: impasse ou receptor encerrado
+    endBlocked(chan, true);
+    receiveReleased = false;
+    if (!sent)
+    {
+        runtimeError = chan->remote() ? "send em canal '" + name + "' cheio: o componente receptor terminou"
+                                      : "impasse: send em canal '" + name + "' cheio (capacidade " +
+                                            std::to_string(chan->capacity()) + ") sem receptor";
+        releaseMessage();
+        return WaitStep::FAILED;
+    }
+    message.clear();
+    if (meterChannels)
+        chan->metrics().onSend(chan->depth());
+    if (chan->remote() && std::find(unflushed.begin(), unflushed.end(), chan) == unflushed.end())
+        unflushed.push_back(chan);
+    if (wake && chan->needsWake())
+    {
+        chan->markWake();
+        wake(chan);
+    }
+    return WaitStep::DONE;
+}
+
+void TACInterpreter::flushRemote()
+{
+    for (SharedChannel *chan : unflushed)
+        chan->flush();
+    unflushed.clear();
+}
+
+void TACInterpreter::leaveBroadcasts(const std::vector<std::string> &names)
+{
+    for (const auto &name : names)
     {
-        if (instrs[i].op == "label")
+        SharedChannel *chan = sharedChannel(name);
+        if (!chan || !chan->broadcast())
+            continue;
+        chan->leave(subscriber(chan));
+        // Produtor estacionado por anel cheio pode ter ganho vaga
+        if (wake && chan->needsWake())
         {
-            std::string fname = instrs[i].result;
-            size_t j = i + 1;
-            while (j < instrs.size() && instrs[j].op == "param")
-            {
-                funcParams[fname].push_back(instrs[j].result); // nome do param
-                ++j;
-            }
+            chan->markWake();
+            wake(chan);
         }
     }
+}
 
-    // Loop manual com ip para permitir saltos
-    size_t ip = 0;
-    while (ip < instrs.size())
+TACInterpreter::WaitStep TACInterpreter::receiveShared(SharedChannel *chan)
+{
+    const size_t reader = subscriber(chan);
+    auto attempt = [&]
+    { return chan->tryPop(message, reader); };
+    releaseMessage();
+    bool got = attempt();
+    if (!got && blockingReceive && !receiveReleased)
     {
-        const auto &ins = instrs[ip];
-
-        // Adicionando log de depuração para cada instrução
-        DBG("DEBUG [ip=" << ip << "]: "
-                         << ins.result << " = (" << ins.op << ") "
-                         << ins.arg1 << (ins.arg2.empty() ? "" : ", " + ins.arg2)
-                         << "\n");
+        if (meterChannels && !blockedSince)
+            blockedSince = SharedChannel::nowNs();
+        WaitStep step = waitShared(chan, false, attempt);
+        if (step != WaitStep::DONE)
+            return step;
+        got = true;
+    }
+    receiveReleased = false;
+    endBlocked(chan, false);
+    if (got && meterChannels)
+        chan->metrics().onReceive();
+    // Vaga aberta: acorda um send estacionado no canal cheio
+    if (got && wake && chan->needsWake())
+    {
+        chan->markWake();
+        wake(chan);
+    }
+    return WaitStep::DONE;
+}
 
-        size_t next_ip = ip + 1; // próximo padrão
-        if (ins.op == "=")
+int TACInterpreter::trySelect(const TACInstruction &ins, unsigned &turn)
+{
+    // Começa no caso seguinte ao último atendido: canais sempre prontos não monopolizam o select
+    const size_t n = ins.args.size();
+    for (size_t j = 0; j < n; ++j)
+    {
+        size_t k = (turn + j) % n;
+        bool got;
+        SharedChannel *chan = sharedChannel(ins.args[k]);
+        ChannelMetrics *metrics = nullptr;
+        if (chan)
         {
-            // Se RHS já é variável string, copia direto
-            if (envStr.count(ins.arg1))
-            {
-                envStr[ins.result] = envStr[ins.arg1];
-            }
-            else if (envF.count(ins.arg1))
-            {
-                envF[ins.result] = envF[ins.arg1];
-            }
-            else if (env.count(ins.arg1))
-            {
-                env[ins.result] = env[ins.arg1];
-            }
-            else
-            {
-                // tentar número literal; se não for, tratar como string literal
-                char *end = nullptr;
-                long v = strtol(ins.arg1.c_str(), &end, 10);
-                if (*end == '\0')
-                {
-                    env[ins.result] = (int)v;
-                }
-                else
-                {
-                    char *endf = nullptr;
-                    double vf = strtod(ins.arg1.c_str(), &endf);
-                    if (*endf == '\0')
-                    {
-                        envF[ins.result] = vf;
-                    }
-                    else
-                    {
-                        envStr[ins.result] = ins.arg1; // literal string crua
-                    }
-                }
-            }
-            // copia de array: se RHS for um identificador de array
-            if (arrays.find(ins.arg1) != arrays.end())
-            {
-                arrays[ins.result] = arrays[ins.arg1];
-                if (arraysNested.count(ins.arg1))
-                    arraysNested[ins.result] = arraysNested[ins.arg1];
-                if (arraysStr.count(ins.arg1))
-                    arraysStr[ins.result] = arraysStr[ins.arg1];
-            }
+            got = chan->tryPop(message, subscriber(chan));
+            metrics = &chan->metrics();
         }
-        else if (ins.op == "+" || ins.op == "-" || ins.op == "*" || ins.op == "/" ||
-                 ins.op == "==" || ins.op == "!=" || ins.op == "<" || ins.op == "<=" ||
-                 ins.op == ">" || ins.op == ">=" || ins.op == "&&" || ins.op == "||" || ins.op == "!")
+        else
         {
-            // Concatenacao de arrays usando '+' se ambos operandos forem arrays
-            if (ins.op == "+" && arrays.find(ins.arg1) != arrays.end() && arrays.find(ins.arg2) != arrays.end())
-            {
-                const auto &leftArr = arrays[ins.arg1];
-                const auto &rightArr = arrays[ins.arg2];
-                std::vector<double> newArr;
-                newArr.reserve(leftArr.size() + rightArr.size());
-                newArr.insert(newArr.end(), leftArr.begin(), leftArr.end());
-                newArr.insert(newArr.end(), rightArr.begin(), rightArr.end());
-                arrays[ins.result] = std::move(newArr);
-                // Concatenar strings paralelas
-                std::vector<std::string> newStrs;
-                const auto &leftStrs = arraysStr[ins.arg1];
-                const auto &rightStrs = arraysStr[ins.arg2];
-                newStrs.reserve(leftStrs.size() + rightStrs.size());
-                newStrs.insert(newStrs.end(), leftStrs.begin(), leftStrs.end());
-                newStrs.insert(newStrs.end(), rightStrs.begin(), rightStrs.end());
-                arraysStr[ins.result] = std::move(newStrs);
-                // Concatenar referencias nested
-                if (arraysNested.count(ins.arg1) || arraysNested.count(ins.arg2))
-                {
-                    std::vector<std::string> newNested;
-                    auto leftN = arraysNested.count(ins.arg1) ? arraysNested[ins.arg1] : std::vector<std::string>(leftArr.size(), "");
-                    auto rightN = arraysNested.count(ins.arg2) ? arraysNested[ins.arg2] : std::vector<std::string>(rightArr.size(), "");
-                    newNested.reserve(leftN.size() + rightN.size());
-                    newNested.insert(newNested.end(), leftN.begin(), leftN.end());
-                    newNested.insert(newNested.end(), rightN.begin(), rightN.end());
-                    arraysNested[ins.result] = std::move(newNested);
-                }
-                // Limpa env numérico para evitar impressão incorreta
-                env.erase(ins.result);
-                envF.erase(ins.result);
-                // já tratou concatenação; seguir para próxima instrução
-                next_ip = ip + 1;
-                ip = next_ip - 1;
-                // Avança sem executar demais blocos
-                ip = next_ip - 1;
-            }
-            // Verifica se algum dos operandos é float (seja como variável ou como literal)
-            bool isFloat1 = envF.count(ins.arg1) || (ins.arg1.find('.') != std::string::npos);
-            bool isFloat2 = envF.count(ins.arg2) || (ins.arg2.find('.') != std::string::npos);
-            bool floatOp = isFloat1 || isFloat2;
+            ChannelRuntime &local = channel(ins.args[k]);
+            got = local.messages.pop(message);
+            metrics = &local.metrics;
+        }
+        if (!got)
+            continue;
+        if (meterChannels)
+            metrics->onReceive();
+        turn = (unsigned)((k + 1) % n);
+        // Vaga aberta: acorda um send estacionado no canal cheio
+        if (chan && wake && chan->needsWake())
+        {
+            chan->markWake();
+            wake(chan);
+        }
+        return (int)k;
+    }
+    return -1;
+}
 
-            if (floatOp && (ins.op == "+" || ins.op == "-" || ins.op == "*" || ins.op == "/"))
+TACInterpreter::WaitStep TACInterpreter::waitSelect(const TACInstruction &ins, unsigned &turn, int &chosen)
+{
+    // Só canais compartilhados podem receber mensagem durante a espera (filas locais são do próprio ramo).
+    // A política é a mais paciente entre eles; giros, cessões e estacionamentos contam em cada um.
+    std::vector<SharedChannel *> chans;
+    ChannelWaitPolicy policy{0, 0};
+    for (const auto &name : ins.args)
+        if (SharedChannel *chan = sharedChannel(name))
+            if (std::find(chans.begin(), chans.end(), chan) == chans.end())
             {
-                double left = valueOf(ins.arg1);
-                double right = valueOf(ins.arg2);
-                double val = 0.0;
-                if (ins.op == "+")
-                    val = left + right;
-                else if (ins.op == "-")
-                    val = left - right;
-                else if (ins.op == "*")
-                    val = left * right;
-                else if (ins.op == "/")
-                    val = (right != 0.0 ? left / right : 0.0);
-                envF[ins.result] = val;
+                chans.push_back(chan);
+                policy.spins = std::max(policy.spins, chan->policy().spins);
+                policy.yields = std::max(policy.yields, chan->policy().yields);
             }
-            else
+    if (chans.empty())
+        return WaitStep::DONE;
+    for (unsigned k = 0; k < policy.spins; ++k)
+    {
+        cpu_relax();
+        if ((chosen = trySelect(ins, turn)) >= 0)
+        {
+            for (SharedChannel *chan : chans)
             {
-                int left = (int)valueOf(ins.arg1);
-                int right = (ins.op == "!") ? 0 : (int)valueOf(ins.arg2);
-                int val = 0;
-                if (ins.op == "+")
-                    val = left + right;
-                else if (ins.op == "-")
-                    val = left - right;
-                else if (ins.op == "*")
-                    val = left * right;
-                else if (ins.op == "/")
-                    val = (right != 0 ? left / right : 0);
-                else if (ins.op == "==")
-                    val = (left == right);
-                else if (ins.op == "!=")
-                    val = (left != right);
-                else if (ins.op == "<")
-                    val = (left < right);
-                else if (ins.op == "<=")
-                    val = (left <= right);
-                else if (ins.op == ">")
-                    val = (left > right);
-                else if (ins.op == ">=")
-                    val = (left >= right);
-                else if (ins.op == "&&")
-                    val = (left && right);
-                else if (ins.op == "||")
-                    val = (left || right);
-                else if (ins.op == "!")
-                    val = (!left);
-                env[ins.result] = val;
+                chan->stats().spins.fetch_add(k + 1, std::memory_order_relaxed);
+                chan->stats().spinHits.fetch_add(1, std::memory_order_relaxed);
             }
+            waitYields = 0;
+            return WaitStep::DONE;
         }
-        else if (ins.op == "print" || ins.op == "print_last")
+    }
+    for (SharedChannel *chan : chans)
+        chan->stats().spins.fetch_add(policy.spins, std::memory_order_relaxed);
+    if (waitYields < policy.yields)
+    {
+        ++waitYields;
+        for (SharedChannel *chan : chans)
+            chan->stats().yields.fetch_add(1, std::memory_order_relaxed);
+        return WaitStep::YIELD;
+    }
+    waitYields = 0;
+    // Canais entre processos são sondados enquanto algum ainda tem emissor vivo; encerrados todos, só
+    // estaciona se houver canal deste processo que ainda possa receber mensagem
+    size_t remote = 0;
+    bool remoteOpen = false;
+    for (SharedChannel *chan : chans)
+        if (chan->remote())
         {
-            // Nova prioridade: arrays primeiro (para evitar imprimir temp de referência), depois string, float, int, literal fallback.
-            if (arrays.find(ins.arg1) != arrays.end())
-            {
-                bool hasString = arraysStr.count(ins.arg1) && !arraysStr[ins.arg1].empty();
-                size_t sz = arrays[ins.arg1].size();
-                out << "[";
-                for (size_t k = 0; k < sz; ++k)
-                {
-                    if (hasString && k < arraysStr[ins.arg1].size() && !arraysStr[ins.arg1][k].empty())
-                    {
-                        out << arraysStr[ins.arg1][k];
-                    }
-                    else if (arraysNested.count(ins.arg1) && k < arraysNested[ins.arg1].size() && !arraysNested[ins.arg1][k].empty())
-                    {
-                        // Representar subarray por nome entre '<>' para depuração
-                        out << "<" << arraysNested[ins.arg1][k] << ">";
-                    }
-                    else
-                    {
-                        double v = arrays[ins.arg1][k];
-                        if (v == (int)v)
-                            out << (int)v;
-                        else
-                            out << v;
-                    }
-                    if (k + 1 < sz)
-                        out << ", ";
-                }
-                out << "]";
-            }
-            else if (envStr.find(ins.arg1) != envStr.end())
-            {
-                out << envStr[ins.arg1];
-            }
-            else if (envF.find(ins.arg1) != envF.end())
-            {
-                out << envF[ins.arg1];
-            }
-            else if (env.find(ins.arg1) != env.end())
-            {
-                out << env[ins.arg1];
-            }
-            else
-            {
-                out << ins.arg1;
-            }
-            if (ins.op == "print_last")
-                out << "\n";
-            else
-                out << " ";
+            ++remote;
+            remoteOpen = remoteOpen || !chan->peerGone(false);
+        }
+    if (remoteOpen)
+    {
+        for (SharedChannel *chan : chans)
+            chan->stats().polls.fetch_add(1, std::memory_order_relaxed);
+        return WaitStep::POLL;
+    }
+    if (remote && remote == chans.size())
+    {
+        receiveReleased = true;
+        return WaitStep::YIELD;
+    }
+    // Registra a espera em todos antes de reconferir: quem mudar qualquer fila em seguida avisará
+    for (SharedChannel *chan : chans)
+        chan->addWaiter();
+    if ((chosen = trySelect(ins, turn)) >= 0)
+    {
+        for (SharedChannel *chan : chans)
+            chan->removeWaiter();
+        return WaitStep::DONE;
+    }
+    waitingKeys.clear();
+    for (SharedChannel *chan : chans)
+    {
+        chan->stats().parks.fetch_add(1, std::memory_order_relaxed);
+        waitingKeys.push_back(chan);
+    }
+    waitingSelect.swap(chans);
+    waitingOn = waitingSelect.front();
+    parkedAt = SharedChannel::nowNs();
+    return WaitStep::PARK;
+}
+
+void TACInterpreter::endSelectWait()
+{
+    // Retomada (aviso de um dos canais ou impasse): a latência conta no canal que avisou
+    bool counted = false;
+    for (SharedChannel *chan : waitingSelect)
+    {
+        chan->removeWaiter();
+        unsigned long long woke = chan->lastWake();
+        if (!counted && woke >= parkedAt)
+        {
+            counted = true;
+            chan->stats().wakes.fetch_add(1, std::memory_order_relaxed);
+            chan->stats().wakeLatencyNs.fetch_add(SharedChannel::nowNs() - woke, std::memory_order_relaxed);
+        }
+    }
+    waitingSelect.clear();
+    waitingKeys.clear();
+}
+
+bool TACInterpreter::canResume() const
+{
+    if (waitingShared)
+        return waitingForSpace ? !waitingShared->full() : !waitingShared->empty(subscribed(waitingShared));
+    for (const SharedChannel *chan : waitingSelect)
+        if (!chan->empty(subscribed(chan)))
+            return true;
+    return false;
+}
+
+void TACInterpreter::emulateCalculator()
+{
+    // Heurística: se temos operacao, valor1, valor2, resultado -> calcula
+    if (is(slotValor1, Value::INT) && is(slotValor2, Value::INT) && is(slotResultado, Value::INT))
+    {
+        int a = slots[slotValor1].i, b = slots[slotValor2].i, res = slots[slotResultado].i;
+        // Operação numérica codificada (1=+,2=-,3=*,4=/) ou string
+        std::string opStr;
+        if (is(slotOperacao, Value::INT))
+            opStr = std::string(1, " +-*/"[slots[slotOperacao].i >= 1 && slots[slotOperacao].i <= 4 ? slots[slotOperacao].i : 0]);
+        else if (is(slotOperacao, Value::STR))
+            opStr = *slots[slotOperacao].s;
+        if (opStr == "+")
+            res = a + b;
+        else if (opStr == "-")
+            res = a - b;
+        else if (opStr == "*")
+            res = a * b;
+        else if (opStr == "/")
+            res = (b != 0 ? a / b : 0);
+        slots[slotResultado].i = res;
+    }
+}
+
+// Concatenação: novo array referenciando os elementos dos dois operandos
+static Value concat_arrays(const Value &left, const Value &right)
+{
+    ArrayObj *merged = new ArrayObj();
+    merged->elems.reserve(left.a->elems.size() + right.a->elems.size());
+    for (const auto &e : left.a->elems)
+        merged->elems.push_back(copy_value(e));
+    for (const auto &e : right.a->elems)
+        merged->elems.push_back(copy_value(e));
+    return Value::ofArray(merged);
+}
+
+// Despacho: com GCC/Clang usa computed goto (threading direto, cada handler salta para o próximo);
+// nos demais compiladores, ou com MINIPAR_SWITCH_DISPATCH definido, só o switch denso sobre o opcode.
+// O laço é instanciado duas vezes (execute<true>/<false>): os handlers têm o label do goto e o case do
+// switch, e setSwitchDispatch escolhe a instância sem custo por instrução.
+#if defined(__GNUC__) && !defined(MINIPAR_SWITCH_DISPATCH)
+#define MINIPAR_THREADED_DISPATCH 1
+#endif
+
+#define FETCH()                                                        \
+    do                                                                 \
+    {                                                                  \
+        if (ip >= n)                                                   \
+            goto finished;                                             \
+        d = &code[ip];                                                 \
+        ins = &instrs[ip];                                             \
+        next_ip = ip + 1;                                              \
+        ++executed;                                                    \
+        DBG("DEBUG [ip=" << ip << "]: "                                \
+                         << ins->result << " = (" << ins->op << ") "   \
+                         << ins->arg1                                  \
+                         << (ins->arg2.empty() ? "" : ", " + ins->arg2) \
+                         << "\n");                                     \
+    } while (0)
+
+#ifdef MINIPAR_THREADED_DISPATCH
+#define OP_LOOP_BEGIN                   \
+    for (;;)                            \
+    {                                   \
+        FETCH();                        \
+        if (Threaded)                   \
+            goto *dispatch[(int)d->op]; \
+        switch (d->op)                  \
+        {
+#define OP_CASE(name) \
+    case TACOp::name: \
+    L_##name:
+#define OP_NEXT                         \
+    ip = next_ip;                       \
+    if (Threaded)                       \
+    {                                   \
+        FETCH();                        \
+        goto *dispatch[(int)d->op];     \
+    }                                   \
+    continue;
+#else
+#define OP_LOOP_BEGIN \
+    for (;;)          \
+    {                 \
+        FETCH();      \
+        switch (d->op)                                                 \
+        {
+#define OP_CASE(name) case TACOp::name:
+#define OP_NEXT     \
+    ip = next_ip;   \
+    continue;
+#endif
+#define OP_LOOP_END   \
+    default:          \
+        ip = next_ip; \
+        continue;     \
+        }             \
+    }
+
+std::unordered_map<std::string, int> TACInterpreter::interpret(const std::vector<TACInstruction> &instrs, std::ostream &out)
+{
+    start(instrs);
+    run(out);
+    return environment();
+}
+
+void TACInterpreter::start(const std::vector<TACInstruction> &instrs)
+{
+    unwindFrames();
+    channels.clear();
+    for (const auto &entry : channelArities)
+        channel(entry.first);
+    for (const auto &entry : channelCapacities)
+        channel(entry.first);
+    releaseMessage();
+    executed = 0;
+    runtimeError.clear();
+    program = &instrs;
+    pc = 0;
+    receiveReleased = false;
+    waitYields = 0;
+    if (waitingShared)
+        waitingShared->removeWaiter();
+    waitingShared = nullptr;
+    for (SharedChannel *chan : waitingSelect)
+        chan->removeWaiter();
+    waitingSelect.clear();
+    waitingKeys.clear();
+    waitingOn = nullptr;
+    subscriptions.clear();
+    blockedSince = 0;
+    load(instrs);
+}
+
+std::unordered_map<std::string, int> TACInterpreter::environment() const
+{
+    std::unordered_map<std::string, int> finalEnv;
+    for (size_t s = 0; s < slotNames.size(); ++s)
+        if (!constantSlot[s] && slots[s].tag == Value::INT)
+            finalEnv[slotNames[s]] = slots[s].i;
+    return finalEnv;
+}
+
+// Canal compartilhado sem vaga/mensagem: reexecuta a instrução corrente ao ceder a fatia ou ao ser acordado
+#define WAIT_PAUSE(step)                                                                \
+    {                                                                                   \
+        --executed;                                                                     \
+        pc = ip;                                                                        \
+        status = (step) == WaitStep::YIELD  ? RunStatus::YIELD                          \
+                 : (step) == WaitStep::POLL ? RunStatus::POLL                           \
+                                            : RunStatus::BLOCKED;                       \
+        goto paused;                                                                    \
+    }
+
+// Fim de fatia: checado só em saltos tomados e chamadas, onde laços e recursão passam
+#define SLICE_CHECK()                \
+    if (executed >= sliceEnd)        \
+    {                                \
+        pc = next_ip;                \
+        status = RunStatus::YIELD;   \
+        goto paused;                 \
+    }
+
+RunStatus TACInterpreter::run(std::ostream &out, unsigned long long slice)
+{
+#ifdef MINIPAR_THREADED_DISPATCH
+    if (!switchDispatch)
+        return execute<true>(out, slice);
+#endif
+    return execute<false>(out, slice);
+}
+
+template <bool Threaded>
+RunStatus TACInterpreter::execute(std::ostream &out, unsigned long long slice)
+{
+#ifdef MINIPAR_THREADED_DISPATCH
+    // Tabela na mesma ordem de TACOp
+    static void *const dispatch[(int)TACOp::COUNT] = {
+        &&L_ASSIGN, &&L_ADD, &&L_SUB, &&L_MUL, &&L_DIV, &&L_EQ, &&L_NE, &&L_LT, &&L_LE, &&L_GT, &&L_GE,
+        &&L_AND, &&L_OR, &&L_NOT, &&L_PRINT, &&L_PRINT_LAST, &&L_LABEL, &&L_IF_FALSE, &&L_GOTO, &&L_PARAM,
+        &&L_ARRAY_CONCAT, &&L_CALL, &&L_RETURN, &&L_SEND_MSG, &&L_RECV_MSG,
+        &&L_SELECT_MSG, &&L_TAKE_MSG,
+        &&L_ARRAY_INIT, &&L_ARRAY_SET, &&L_ARRAY_GET, &&L_ARRAY_APPEND, &&L_NOP};
+#endif
+
+    // Loop manual com ip para permitir saltos
+    const std::vector<TACInstruction> &instrs = *program;
+    const size_t n = instrs.size();
+    size_t ip = pc;
+    size_t next_ip = 0;
+    const unsigned long long sliceEnd = slice ? executed + slice : ~0ULL;
+    RunStatus status = RunStatus::DONE;
+    // Retomada: a espera registrada no canal compartilhado termina aqui
+    if (waitingShared)
+    {
+        waitingShared->removeWaiter();
+        // Aviso posterior ao estacionamento: retomada pedida por outro ramo (não por impasse)
+        unsigned long long woke = waitingShared->lastWake();
+        if (woke >= parkedAt)
+        {
+            ChannelWaitStats &stats = waitingShared->stats();
+            stats.wakes.fetch_add(1, std::memory_order_relaxed);
+            stats.wakeLatencyNs.fetch_add(SharedChannel::nowNs() - woke, std::memory_order_relaxed);
+        }
+    }
+    waitingShared = nullptr;
+    if (!waitingSelect.empty())
+        endSelectWait();
+    waitingOn = nullptr;
+    const DecodedInstr *d = nullptr;
+    const TACInstruction *ins = nullptr;
+
+    OP_LOOP_BEGIN
+
+    OP_CASE(ASSIGN)
+    {
+        // Cópia do valor do RHS (arrays compartilhados); RHS indefinido é literal numérico ou string crua
+        store(d->result, resolve(d->arg1));
+    }
+    OP_NEXT
+
+    OP_CASE(ADD)
+    OP_CASE(SUB)
+    OP_CASE(MUL)
+    OP_CASE(DIV)
+    {
+        const Value &lhs = operand(d->arg1), &rhs = operand(d->arg2);
+        // Concatenacao de arrays usando '+' se ambos operandos forem arrays
+        if (d->op == TACOp::ADD && lhs.tag == Value::ARRAY && rhs.tag == Value::ARRAY)
+        {
+            store(d->result, concat_arrays(lhs, rhs));
         }
-        else if (ins.op == "label")
+        // Operação float se algum operando é float (seja como variável ou como literal)
+        else if (lhs.tag == Value::FLOAT || rhs.tag == Value::FLOAT)
         {
-            // nada a fazer
-            // Se este label é o destino do salto inicial e estamos retornando de função sem callStack, podemos encerrar
-            if (callStack.empty() && ins.result.size() && ins.result[0] == 'L' && ip + 1 == instrs.size())
+            double left = lhs.number();
+            double right = rhs.number();
+            double val = 0.0;
+            switch (d->op)
             {
+            case TACOp::ADD:
+                val = left + right;
+                break;
+            case TACOp::SUB:
+                val = left - right;
+                break;
+            case TACOp::MUL:
+                val = left * right;
+                break;
+            default:
+                val = (right != 0.0 ? left / right : 0.0);
                 break;
             }
+            store(d->result, Value::ofFloat(val));
         }
-        else if (ins.op == "if_false")
+        else
         {
-            double cond = valueOf(ins.arg1);
-            if (cond == 0.0)
+            int left = (int)lhs.number();
+            int right = (int)rhs.number();
+            int val = 0;
+            switch (d->op)
             {
-                auto it = labelMap.find(ins.arg2);
-                if (it != labelMap.end())
-                    next_ip = it->second + 1;
+            case TACOp::ADD:
+                val = left + right;
+                break;
+            case TACOp::SUB:
+                val = left - right;
+                break;
+            case TACOp::MUL:
+                val = left * right;
+                break;
+            default:
+                val = (right != 0 ? left / right : 0);
+                break;
             }
+            store(d->result, Value::ofInt(val));
+        }
+    }
+    OP_NEXT
+
+    OP_CASE(EQ)
+    OP_CASE(NE)
+    OP_CASE(LT)
+    OP_CASE(LE)
+    OP_CASE(GT)
+    OP_CASE(GE)
+    OP_CASE(AND)
+    OP_CASE(OR)
+    OP_CASE(NOT)
+    {
+        // Comparações e lógicos sempre operam sobre inteiros
+        int left = (int)valueOf(d->arg1);
+        int right = (d->op == TACOp::NOT) ? 0 : (int)valueOf(d->arg2);
+        int val = 0;
+        switch (d->op)
+        {
+        case TACOp::EQ:
+            val = (left == right);
+            break;
+        case TACOp::NE:
+            val = (left != right);
+            break;
+        case TACOp::LT:
+            val = (left < right);
+            break;
+        case TACOp::LE:
+            val = (left <= right);
+            break;
+        case TACOp::GT:
+            val = (left > right);
+            break;
+        case TACOp::GE:
+            val = (left >= right);
+            break;
+        case TACOp::AND:
+            val = (left && right);
+            break;
+        case TACOp::OR:
+            val = (left || right);
+            break;
+        default:
+            val = (!left);
+            break;
+        }
+        store(d->result, Value::ofInt(val));
+    }
+    OP_NEXT
+
+    OP_CASE(PRINT)
+    OP_CASE(PRINT_LAST)
+    {
+        // Valor impresso conforme a tag; nome indefinido é impresso pela sua leitura literal
+        if (d->arg1 >= 0)
+            print_value(out, operand(d->arg1));
+        if (d->op == TACOp::PRINT_LAST)
+            out << "\n";
+        else
+            out << " ";
+    }
+    OP_NEXT
+
+    OP_CASE(LABEL)
+    {
+        // Se este label é o destino do salto inicial e estamos retornando de função sem callStack, podemos encerrar
+        if (callStack.empty() && ins->result.size() && ins->result[0] == 'L' && ip + 1 == n)
+            goto finished;
+    }
+    OP_NEXT
+
+    OP_CASE(IF_FALSE)
+    {
+        if (valueOf(d->arg1) == 0.0 && d->target >= 0)
+        {
+            next_ip = (size_t)d->target;
+            SLICE_CHECK();
+        }
+    }
+    OP_NEXT
+
+    OP_CASE(GOTO)
+    {
+        if (d->target >= 0)
+        {
+            next_ip = (size_t)d->target;
+            SLICE_CHECK();
         }
-        else if (ins.op == "goto")
+    }
+    OP_NEXT
+
+    OP_CASE(PARAM)
+    {
+        // param X = argY; argY indefinido vale 0
+        if (d->arg1 >= 0 && ref(d->arg1).tag != Value::NONE)
+            store(d->result, copy_value(ref(d->arg1)));
+        else
+            store(d->result, Value::ofInt(0));
+    }
+    OP_NEXT
+
+    OP_CASE(ARRAY_CONCAT)
+    {
+        // Concatenação explícita emitida pelo gerador
+        const Value &lhs = operand(d->arg1), &rhs = operand(d->arg2);
+        if (lhs.tag == Value::ARRAY && rhs.tag == Value::ARRAY)
+            store(d->result, concat_arrays(lhs, rhs));
+    }
+    OP_NEXT
+
+    OP_CASE(CALL)
+    {
+        // arg1 = function name, arg2 = arg count, result = temp for return
+        if (d->target >= 0)
         {
-            // arg1 contém label destino
-            auto it = labelMap.find(ins.arg1);
-            if (it != labelMap.end())
-                next_ip = it->second + 1;
+            // Novo frame na arena, com cada local começando pela sua leitura literal
+            const FunctionInfo &fn = functions[d->func];
+            CallFrame frame{next_ip, d->result, true, fp, {}, fn.localInit.size()};
+            fp = arena.push(frame.nlocals, frame.mark);
+            std::copy(fn.localInit.begin(), fn.localInit.end(), fp);
+            callStack.push_back(frame);
+            next_ip = (size_t)d->target; // after label, params will be processed
+            SLICE_CHECK();
         }
-        else if (ins.op == "param")
+    }
+    OP_NEXT
+
+    OP_CASE(RETURN)
+    {
+        // arg1 holds temp return value (already a temp or literal)
+        if (!callStack.empty())
         {
-            // param X = argY; argY may be in env or envF; if missing default 0
-            if (env.count(ins.arg1))
-                env[ins.result] = env[ins.arg1];
-            else if (envF.count(ins.arg1))
-                envF[ins.result] = envF[ins.arg1];
-            else if (envStr.count(ins.arg1))
-                envStr[ins.result] = envStr[ins.arg1];
+            CallFrame frame = callStack.back();
+            callStack.pop_back();
+            Value ret = resolve(d->arg1);
+            // descarta o frame do chamado e volta ao de quem chamou
+            for (size_t k = 0; k < frame.nlocals; ++k)
+                release_value(fp[k]);
+            arena.pop(frame.mark);
+            fp = frame.caller_fp;
+            // move return value into target temp
+            if (frame.has_target && frame.return_target >= 0)
+                store(frame.return_target, ret);
             else
-            {
-                env[ins.result] = 0;
-            }
+                release_value(ret);
+            next_ip = frame.return_ip;
         }
-        else if (ins.op == "array_concat")
+    }
+    OP_NEXT
+
+    OP_CASE(SEND_MSG)
+    {
+        // Mensagem inteira numa instrução. Arrays vão como handle: movidos quando o emissor não os lê mais,
+        // senão com uma referência a mais (copy-on-write só se alguém escrever depois).
+        if (!pendingSend)
         {
-            // Concatenação explícita emitida pelo gerador
-            if (arrays.count(ins.arg1) && arrays.count(ins.arg2))
+            message.clear();
+            for (int k = 0; k < d->count; ++k)
             {
-                const auto &A = arrays[ins.arg1];
-                const auto &B = arrays[ins.arg2];
-                std::vector<double> merged;
-                merged.reserve(A.size() + B.size());
-                merged.insert(merged.end(), A.begin(), A.end());
-                merged.insert(merged.end(), B.begin(), B.end());
-                arrays[ins.result] = std::move(merged);
-                // Strings
-                std::vector<std::string> mergedStr;
-                const auto &AS = arraysStr[ins.arg1];
-                const auto &BS = arraysStr[ins.arg2];
-                mergedStr.reserve(AS.size() + BS.size());
-                mergedStr.insert(mergedStr.end(), AS.begin(), AS.end());
-                mergedStr.insert(mergedStr.end(), BS.begin(), BS.end());
-                arraysStr[ins.result] = std::move(mergedStr);
-                // Nested references
-                if (arraysNested.count(ins.arg1) || arraysNested.count(ins.arg2))
+                int slot = operandLists[d->list + k];
+                if (moveOperand[d->list + k] && is(slot, Value::ARRAY))
                 {
-                    std::vector<std::string> mergedN;
-                    auto AN = arraysNested.count(ins.arg1) ? arraysNested[ins.arg1] : std::vector<std::string>(A.size(), "");
-                    auto BN = arraysNested.count(ins.arg2) ? arraysNested[ins.arg2] : std::vector<std::string>(B.size(), "");
-                    mergedN.reserve(AN.size() + BN.size());
-                    mergedN.insert(mergedN.end(), AN.begin(), AN.end());
-                    mergedN.insert(mergedN.end(), BN.begin(), BN.end());
-                    arraysNested[ins.result] = std::move(mergedN);
+                    message.push_back(ref(slot));
+                    ref(slot) = Value();
                 }
-                // Limpa env numérico para não confundir com escalar
-                env.erase(ins.result);
-                envF.erase(ins.result);
+                else
+                    message.push_back(resolve(slot));
             }
         }
-        else if (ins.op == "call")
+        pendingSend = false;
+        if (SharedChannel *chan = sharedChannel(ins->arg1))
         {
-            // ins.arg1 = function name, ins.arg2 = arg count, result = temp for return
-            auto it = labelMap.find(ins.arg1);
-            if (it != labelMap.end())
+            // Sem vaga: a mensagem montada (e o que foi movido para ela) espera a reexecução
+            WaitStep step = sendShared(chan, ins->arg1);
+            if (step == WaitStep::FAILED)
+                goto finished;
+            if (step != WaitStep::DONE)
             {
-                callStack.push_back({next_ip, ins.result, true});
-                next_ip = it->second + 1; // after label, params will be processed
+                pendingSend = true;
+                WAIT_PAUSE(step);
             }
         }
-        else if (ins.op == "return")
+        else if (!sendLocal(ins->arg1))
+            goto finished;
+    }
+    OP_NEXT
+
+    OP_CASE(RECV_MSG)
+    {
+        if (SharedChannel *chan = sharedChannel(ins->arg1))
+        {
+            WaitStep step = receiveShared(chan);
+            if (step != WaitStep::DONE)
+                WAIT_PAUSE(step);
+        }
+        else
         {
-            // ins.arg1 holds temp return value (already a temp or literal)
-            if (!callStack.empty())
-            {
-                auto frame = callStack.back();
-                callStack.pop_back();
-                // move return value into target temp
-                if (frame.has_target)
-                {
-                    if (envF.count(ins.arg1))
-                        envF[frame.return_target] = envF[ins.arg1];
-                    else if (env.count(ins.arg1))
-                        env[frame.return_target] = env[ins.arg1];
-                    else if (envStr.count(ins.arg1))
-                        envStr[frame.return_target] = envStr[ins.arg1];
-                    else
-                    {
-                        // literal number fallback
-                        char *e = nullptr;
-                        long vi = strtol(ins.arg1.c_str(), &e, 10);
-                        if (*e == '\0')
-                            env[frame.return_target] = (int)vi;
-                        else
-                        {
-                            char *ef = nullptr;
-                            double vf = strtod(ins.arg1.c_str(), &ef);
-                            if (*ef == '\0')
-                                envF[frame.return_target] = vf;
-                            else
-                                envStr[frame.return_target] = ins.arg1;
-                        }
-                    }
-                }
-                next_ip = frame.return_ip;
-            }
+            // Fila local é privada deste interpretador (canal de um único ramo): vazia, nada a esperar
+            releaseMessage();
+            ChannelRuntime &local = channel(ins->arg1);
+            if (local.messages.pop(message) && meterChannels)
+                local.metrics.onReceive();
         }
-        else if (ins.op == "send")
+        // Só mensagem com a aridade esperada é ligada às variáveis (canal vazio as deixa intactas);
+        // os valores passam da mensagem para as variáveis sem cópia
+        if (message.size() == (size_t)d->count)
         {
-            finalizeSend();
-            buildingChannel = ins.arg1; // canal
-            expectedSendArgs = (size_t)valueOf(ins.arg2);
-            buildingMessage.clear();
+            for (int k = 0; k < d->count; ++k)
+                store(operandLists[d->list + k], message[k]);
+            message.clear();
+            emulateCalculator();
         }
-        else if (ins.op == "send_arg")
+        else
+            releaseMessage();
+    }
+    OP_NEXT
+
+    OP_CASE(SELECT_MSG)
+    {
+        // Primeira mensagem entre os canais do select (rodízio entre casos prontos); fica em message até o
+        // take_msg do caso escolhido. Sem mensagem após impasse (ou fora de PAR), nenhum caso roda (-1).
+        unsigned &turn = selectTurn[ip];
+        releaseMessage();
+        int chosen = trySelect(*ins, turn);
+        if (chosen < 0 && blockingReceive && !receiveReleased)
         {
-            if (buildingChannel == ins.result)
-            {
-                buildingMessage.push_back(valueOf(ins.arg1));
-                if (buildingMessage.size() == expectedSendArgs)
-                    finalizeSend();
-            }
+            if (meterChannels && !blockedSince)
+                blockedSince = SharedChannel::nowNs();
+            WaitStep step = waitSelect(*ins, turn, chosen);
+            if (step != WaitStep::DONE)
+                WAIT_PAUSE(step);
         }
-        else if (ins.op == "receive")
+        receiveReleased = false;
+        // Espera do select conta no canal atendido
+        endBlocked(chosen >= 0 ? sharedChannel(ins->args[chosen]) : nullptr, false);
+        store(d->result, Value::ofInt(chosen));
+    }
+    OP_NEXT
+
+    OP_CASE(TAKE_MSG)
+    {
+        if (message.size() == (size_t)d->count)
         {
-            finalizeReceive();
-            receivingChannel = ins.arg1;
-            expectedRecvArgs = (size_t)valueOf(ins.arg2);
-            receivedMessage.clear();
-            // pop mensagem do canal (se existir)
-            auto &queue = channels[receivingChannel].messages;
-            if (!queue.empty())
-            {
-                receivedMessage = queue.front();
-                queue.erase(queue.begin());
-            }
+            for (int k = 0; k < d->count; ++k)
+                store(operandLists[d->list + k], message[k]);
+            message.clear();
+            emulateCalculator();
         }
-        else if (ins.op == "recv_arg")
+        else
+            releaseMessage();
+    }
+    OP_NEXT
+
+    OP_CASE(ARRAY_INIT)
+    {
+        ArrayObj *arr = new ArrayObj();
+        arr->elems.assign((size_t)valueOf(d->arg1), Value::ofInt(0));
+        store(d->result, Value::ofArray(arr));
+    }
+    OP_NEXT
+
+    OP_CASE(ARRAY_SET)
+    {
+        // result[arg2] = arg1; o array destino é desacoplado de outros donos antes da escrita
+        if (is(d->result, Value::ARRAY))
         {
-            if (receivedMessage.size() == expectedRecvArgs && receivingChannel == ins.arg1)
+            size_t idx = (size_t)valueOf(d->arg2);
+            if (idx < ref(d->result).a->elems.size())
             {
-                size_t pos = (size_t)valueOf(ins.arg2);
-                int v = (pos < receivedMessage.size() ? receivedMessage[pos] : 0);
-                env[ins.result] = v;
-                // se chegou na última variável, finalize para cálculo
-                // se pos == expectedRecvArgs-1, última variável
-                if (pos == expectedRecvArgs - 1)
-                    finalizeReceive();
+                // valor lido antes do desacoplamento: `a[i] = a` guarda o array antigo, sem criar ciclo
+                Value v = resolve(d->arg1);
+                Value &elem = unshare_array(ref(d->result))->elems[idx];
+                release_value(elem);
+                elem = v;
             }
         }
-        else if (ins.op == "array_init")
+    }
+    OP_NEXT
+
+    OP_CASE(ARRAY_GET)
+    {
+        // Elemento (escalar, string ou subarray compartilhado); base que não é array ou índice fora do limite vale 0
+        Value v = Value::ofInt(0);
+        if (is(d->arg1, Value::ARRAY))
         {
-            size_t sz = (size_t)valueOf(ins.arg1);
-            arrays[ins.result] = std::vector<double>(sz, 0.0);
-            // Inicializa estrutura nested apenas; manter vazio para evitar acessos inválidos se não usado
-            arraysNested[ins.result] = std::vector<std::string>(sz, "");
-            arraysStr[ins.result] = std::vector<std::string>(sz, "");
+            size_t idx = (size_t)valueOf(d->arg2);
+            const auto &elems = ref(d->arg1).a->elems;
+            if (idx < elems.size())
+                v = copy_value(elems[idx]);
         }
-        else if (ins.op == "array_set")
+        store(d->result, v);
+    }
+    OP_NEXT
+
+    OP_CASE(ARRAY_APPEND)
+    {
+        // result = arg1 + arg2 seguido de arg1 = result, com result sem outras leituras
+        const Value &lhs = operand(d->arg1), &rhs = operand(d->arg2);
+        if (lhs.tag == Value::ARRAY && rhs.tag == Value::ARRAY)
         {
-            // result[arg2] = arg1
-            auto it = arrays.find(ins.result);
-            if (it != arrays.end())
-            {
-                size_t idx = (size_t)valueOf(ins.arg2);
-                bool rhsIsArray = arrays.find(ins.arg1) != arrays.end();
-                if (idx < it->second.size())
-                {
-                    if (rhsIsArray)
-                    {
-                        // Apenas registra referência, não sobrescreve vetor numérico (mantém valor dummy)
-                        auto &nestVec = arraysNested[ins.result];
-                        if (nestVec.empty())
-                            nestVec = std::vector<std::string>(it->second.size(), "");
-                        nestVec[idx] = ins.arg1;
-                        // strings aninhadas são tratadas copiando vetor de strings correspondente
-                        if (arraysStr.count(ins.arg1))
-                        {
-                            if (arraysStr[ins.result].size() < it->second.size())
-                                arraysStr[ins.result].resize(it->second.size());
-                            // Não é coleção de strings diretas, mas manter vazio.
-                        }
-                    }
-                    else
-                    {
-                        // Decide se é string ou numérico (heurística semelhante à atribuição '=')
-                        // 1. Se já é variável string
-                        if (envStr.count(ins.arg1))
-                        {
-                            arraysStr[ins.result][idx] = envStr[ins.arg1];
-                        }
-                        // 2. Se é variável float
-                        else if (envF.count(ins.arg1))
-                        {
-                            it->second[idx] = envF[ins.arg1];
-                        }
-                        // 3. Se é variável int
-                        else if (env.count(ins.arg1))
-                        {
-                            it->second[idx] = (double)env[ins.arg1];
-                        }
-                        else
-                        {
-                            // 4. Tenta literal numérico (int ou float). Se não for, trata como string literal.
-                            char *endInt = nullptr;
-                            long vi = strtol(ins.arg1.c_str(), &endInt, 10);
-                            char *endF = nullptr;
-                            double vf = strtod(ins.arg1.c_str(), &endF);
-                            if (*endF == '\0')
-                            {
-                                it->second[idx] = vf; // literal float ou int consumido como float
-                            }
-                            else if (*endInt == '\0')
-                            {
-                                it->second[idx] = (double)vi; // literal int
-                            }
-                            else
-                            {
-                                // 5. String literal crua (ex: Joao, Smartphone, etc.)
-                                arraysStr[ins.result][idx] = ins.arg1;
-                            }
-                        }
-                    }
-                }
-            }
+            // rhs pode ser o próprio arg1 (`x = x + x`): a referência extra o mantém intacto durante a cópia
+            Value tail = copy_value(rhs);
+            ArrayObj *arr = unshare_array(ref(d->arg1));
+            const size_t count = tail.a->elems.size();
+            for (size_t k = 0; k < count; ++k)
+                arr->elems.push_back(copy_value(tail.a->elems[k]));
+            release_value(tail);
+            if (!d->inPlace)
+                next_ip = ip + 2; // a cópia `arg1 = result` já está feita
         }
-        else if (ins.op == "array_get")
+        else if (d->fused == TACOp::ADD)
         {
-            // Suporte a acesso sequencial: se elemento for subarray referenciado em arraysNested, copia subarray
-            auto it = arrays.find(ins.arg1);
-            if (it == arrays.end())
-            {
-                env[ins.result] = 0;
-                envF[ins.result] = 0.0;
-            }
+            // Operandos não-array: soma numérica do '+' original; a cópia seguinte executa normalmente
+            if (lhs.tag == Value::FLOAT || rhs.tag == Value::FLOAT)
+                store(d->result, Value::ofFloat(lhs.number() + rhs.number()));
             else
-            {
-                size_t idx = (size_t)valueOf(ins.arg2);
-                double val = 0.0;
-                bool handledSubarray = false;
-                // Verifica referência aninhada
-                auto nestedIt = arraysNested.find(ins.arg1);
-                if (nestedIt != arraysNested.end() && idx < nestedIt->second.size())
-                {
-                    const std::string &subName = nestedIt->second[idx];
-                    if (!subName.empty() && arrays.count(subName))
-                    {
-                        // Copia conteúdo da linha/subarray para novo temp
-                        arrays[ins.result] = arrays[subName];
-                        // Copia estrutura nested adicional (permite 3D futuramente)
-                        if (arraysNested.count(subName))
-                            arraysNested[ins.result] = arraysNested[subName];
-                        if (arraysStr.count(subName))
-                            arraysStr[ins.result] = arraysStr[subName];
-                        handledSubarray = true;
-                        env[ins.result] = 0;
-                        envF[ins.result] = 0.0;
-                    }
-                }
-                if (!handledSubarray)
-                {
-                    if (idx < it->second.size())
-                        val = it->second[idx];
-                    // Se houver string nesse índice, prioriza string
-                    if (arraysStr.count(ins.arg1) && idx < arraysStr[ins.arg1].size() && !arraysStr[ins.arg1][idx].empty())
-                    {
-                        envStr[ins.result] = arraysStr[ins.arg1][idx];
-                        // não define env/int placeholder para evitar sobrescrever string em atribuições futuras
-                        envF.erase(ins.result);
-                        env.erase(ins.result);
-                    }
-                    else
-                    {
-                        // Preserva tanto int quanto float; se valor tem parte fracionária manter envF.
-                        envF[ins.result] = val;
-                        env[ins.result] = (int)val; // ainda armazena inteiro para operações booleanas
-                    }
-                }
-            }
+                store(d->result, Value::ofInt((int)lhs.number() + (int)rhs.number()));
         }
-        ip = next_ip;
     }
-    finalizeSend();
-    finalizeReceive();
-    return env;
+    OP_NEXT
+
+    OP_CASE(NOP)
+    OP_NEXT
+
+    OP_LOOP_END
+
+finished:
+    pc = n;
+    flushRemote();
+    return RunStatus::DONE;
+
+paused:
+    flushRemote();
+    return status;
 }
@@ -126,6 +126,14 @@ static void walk_node(ASTNode *node, SymbolTable &table, Symbol *currentFunction
             register_identifier(v, table);
         }
     }
+    else if (auto sel = dynamic_cast<SelectNode *>(node))
+    {
+        for (size_t k = 0; k < sel->cases.size(); ++k)
+        {
+            walk_node(sel->cases[k].get(), table, currentFunction);
+            walk_node(sel->bodies[k].get(), table, currentFunction);
+        }
+    }
     else if (auto ch = dynamic_cast<ChannelDeclNode *>(node))
     {
         if (!table.symbol_exists(ch->name))
@@ -235,31 +235,58 @@ void TACGenerator::generate_statement(ASTNode *stmt)
     }
     else if (auto send = dynamic_cast<SendNode *>(stmt))
     {
-        // Avalia todos os argumentos e gera pacote de envio
-        vector<string> temps;
+        // Avalia todos os argumentos; a mensagem inteira sai numa única instrução
+        TACInstruction msg("", "send_msg", send->channelName);
         for (auto &a : send->arguments)
-            temps.push_back(generate_expression(a.get()));
-        // Instrução principal com contagem
-        instructions.push_back(TACInstruction("", "send", send->channelName, to_string(temps.size())));
-        // Instruções de argumento (canal, valor, índice)
-        for (size_t i = 0; i < temps.size(); ++i)
-        {
-            instructions.push_back(TACInstruction(send->channelName, "send_arg", temps[i], to_string(i)));
-        }
+            msg.args.push_back(generate_expression(a.get()));
+        instructions.push_back(msg);
     }
     else if (auto recv = dynamic_cast<ReceiveNode *>(stmt))
     {
-        // Instrução principal de receive com quantidade esperada
-        instructions.push_back(TACInstruction("", "receive", recv->channelName, to_string(recv->variables.size())));
-        // Bind de cada variável (var = recv canal idx)
-        for (size_t i = 0; i < recv->variables.size(); ++i)
-        {
-            instructions.push_back(TACInstruction(recv->variables[i], "recv_arg", recv->channelName, to_string(i)));
+        // Uma instrução recebe a mensagem e liga cada posição à variável correspondente
+        TACInstruction msg("", "recv_msg", recv->channelName);
+        msg.args = recv->variables;
+        instructions.push_back(msg);
+    }
+    else if (auto sel = dynamic_cast<SelectNode *>(stmt))
+    {
+        // Estrutura: t = select (canais...), e para cada caso k: t == k ? take (vars); corpo; goto end.
+        // select espera a primeira mensagem entre os canais e guarda o índice do caso (-1 se nenhuma);
+        // take liga a mensagem retirada pelo select às variáveis do caso
+        string chosen = new_temp();
+        TACInstruction select(chosen, "select_msg");
+        for (auto &c : sel->cases)
+            select.args.push_back(c->channelName);
+        instructions.push_back(select);
+        string endLabel = new_label();
+        for (size_t k = 0; k < sel->cases.size(); ++k)
+        {
+            string index = new_temp();
+            instructions.push_back(TACInstruction(index, "=", to_string(k)));
+            string cond = new_temp();
+            instructions.push_back(TACInstruction(cond, "==", chosen, index));
+            string nextLabel = new_label();
+            instructions.push_back(TACInstruction("", "if_false", cond, nextLabel));
+            TACInstruction take("", "take_msg");
+            take.args = sel->cases[k]->variables;
+            instructions.push_back(take);
+            for (auto &s : sel->bodies[k]->statements)
+                generate_statement(s.get());
+            instructions.push_back(TACInstruction("", "goto", endLabel));
+            instructions.push_back(TACInstruction(nextLabel, "label", ""));
         }
+        instructions.push_back(TACInstruction(endLabel, "label", ""));
     }
     else if (dynamic_cast<FunctionDeclNode *>(stmt))
     { /* função tratada em generate() */
     }
+    else if (auto global = dynamic_cast<GlobalDeclNode *>(stmt))
+    {
+        // Só marca o nome para o interpretador (que faz local da chamada todo nome escrito no corpo)
+        if (inFunction)
+            for (const auto &name : global->names)
+                instructions.push_back(TACInstruction(name, "global", ""));
+    }
     else if (auto ret = dynamic_cast<ReturnNode *>(stmt))
     {
         string valTemp = ret->value ? generate_expression(ret->value.get()) : "";
@@ -507,7 +534,12 @@ string TACGenerator::generate_expression(ASTNode *node)
 
 void TACGenerator::print_tac(std::ostream &out)
 {
-    for (const auto &instr : instructions)
+    print(instructions, out);
+}
+
+void TACGenerator::print(const std::vector<TACInstruction> &code, std::ostream &out)
+{
+    for (const auto &instr : code)
     {
         if (instr.op == "print")
         {
@@ -534,21 +566,22 @@ void TACGenerator::print_tac(std::ostream &out)
         {
             out << instr.result << " = " << instr.arg1 << "\n";
         }
-        else if (instr.op == "send")
-        {
-            out << "send " << instr.arg1 << " count=" << instr.arg2 << "\n";
-        }
-        else if (instr.op == "send_arg")
+        else if (instr.op == "send_msg" || instr.op == "recv_msg")
         {
-            out << instr.result << "[" << instr.arg2 << "] <= " << instr.arg1 << "\n";
+            out << (instr.op == "send_msg" ? "send " : "receive ") << instr.arg1 << " (";
+            for (size_t i = 0; i < instr.args.size(); ++i)
+                out << (i ? ", " : "") << instr.args[i];
+            out << ")\n";
         }
-        else if (instr.op == "receive")
+        else if (instr.op == "select_msg" || instr.op == "take_msg")
         {
-            out << "receive " << instr.arg1 << " count=" << instr.arg2 << "\n";
-        }
-        else if (instr.op == "recv_arg")
-        {
-            out << instr.result << " = recv " << instr.arg1 << "[" << instr.arg2 << "]\n";
+            if (instr.op == "select_msg")
+                out << instr.result << " = select (";
+            else
+                out << "take (";
+            for (size_t i = 0; i < instr.args.size(); ++i)
+                out << (i ? ", " : "") << instr.args[i];
+            out << ")\n";
         }
         else if (instr.op == "array_init")
         {
@@ -566,6 +599,10 @@ void TACGenerator::print_tac(std::ostream &out)
         {
             out << instr.result << " = concat " << instr.arg1 << ", " << instr.arg2 << "\n";
         }
+        else if (instr.op == "global")
+        {
+            out << "global " << instr.result << "\n";
+        }
         else if (instr.op == "input")
         {
             out << instr.result << " = input()\n";
@@ -0,0 +1,177 @@
+#include "broadcast_ring.h"
+#include <algorithm>
+#include <thread>
+
+BroadcastRing::BroadcastRing(size_t arity, size_t capacity) : width(arity), cap(capacity ? capacity : 1)
+{
+    buf.assign(cap * (width + 1), Value());
+    sequence.reset(new std::atomic<size_t>[cap]);
+    remaining.reset(new std::atomic<size_t>[cap]);
+    goneAt.reset(new std::atomic<size_t>[cap]);
+    for (size_t k = 0; k < cap; ++k)
+    {
+        sequence[k].store(k, std::memory_order_relaxed);
+        remaining[k].store(0, std::memory_order_relaxed);
+        goneAt[k].store(0, std::memory_order_relaxed);
+    }
+    cursors.resize(1);
+}
+
+void BroadcastRing::reset(size_t readers)
+{
+    // Sem ramos rodando: as posições publicadas e não liberadas são exatamente o final da janela
+    const size_t end = enqueuePos.load(std::memory_order_relaxed);
+    size_t oldest = end;
+    for (size_t pos = end > cap ? end - cap : 0; pos < end; ++pos)
+        if (sequence[pos % cap].load(std::memory_order_relaxed) == pos + 1)
+        {
+            oldest = pos;
+            break;
+        }
+    for (size_t pos = oldest; pos < end; ++pos)
+    {
+        remaining[pos % cap].store(readers, std::memory_order_relaxed);
+        goneAt[pos % cap].store(0, std::memory_order_relaxed);
+    }
+    readerCount = readers;
+    cursors.assign(std::max(readers, (size_t)1), Cursor{oldest});
+    nextReader.store(0, std::memory_order_relaxed);
+    departed.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+}
+
+bool BroadcastRing::tryPush(Value *msg, size_t len)
+{
+    size_t pos = enqueuePos.load(std::memory_order_relaxed);
+    for (;;)
+    {
+        // seq == pos: posição livre nesta volta; seq < pos: algum assinante ainda não passou (cheia)
+        const size_t seq = sequence[pos % cap].load(std::memory_order_acquire);
+        const long diff = (long)seq - (long)pos;
+        if (diff == 0)
+        {
+            // seq_cst com a leitura de departed abaixo: ver leave
+            if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_seq_cst,
+                                                 std::memory_order_relaxed))
+                break;
+        }
+        else if (diff < 0)
+            return false;
+        else
+            pos = enqueuePos.load(std::memory_order_relaxed);
+    }
+    for (size_t k = width; k < len; ++k)
+        release_value(msg[k]);
+    len = std::min(len, width);
+    Value *dst = slot(pos);
+    dst[0] = Value::ofInt((int)len);
+    std::copy(msg, msg + len, dst + 1);
+    // Todos saíram: remaining 0, a posição fica retida para o bloco seguinte (reset)
+    const size_t gone = departed.load(std::memory_order_seq_cst);
+    remaining[pos % cap].store(readerCount - gone, std::memory_order_relaxed);
+    goneAt[pos % cap].store(gone, std::memory_order_relaxed);
+    sequence[pos % cap].store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+bool BroadcastRing::leave(size_t reader)
+{
+    if (reader >= readerCount || cursors[reader].pos.load(std::memory_order_relaxed) == GONE)
+        return false;
+    size_t pos = cursors[reader].pos.load(std::memory_order_relaxed);
+    cursors[reader].pos.store(GONE, std::memory_order_relaxed);
+    // Posição reservada depois de lido `end` vê a saída (as duas operações de cada lado são seq_cst) e é
+    // publicada sem contar este assinante. Das anteriores, contam com ele as publicadas com goneAt <= order.
+    const size_t order = departed.fetch_add(1, std::memory_order_seq_cst);
+    if (order + 1 >= readerCount)
+        return false;
+    const size_t end = enqueuePos.load(std::memory_order_seq_cst);
+    for (; pos < end; ++pos)
+    {
+        std::atomic<size_t> &seq = sequence[pos % cap];
+        // Reservada e ainda não publicada: o produtor está entre a reserva e a publicação
+        size_t s;
+        while ((long)((s = seq.load(std::memory_order_acquire)) - (pos + 1)) < 0)
+            std::this_thread::yield();
+        // Já liberada (ou reaproveitada) sem este assinante: não contava com ele
+        if (s != pos + 1)
+            continue;
+        const size_t at = goneAt[pos % cap].load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (seq.load(std::memory_order_relaxed) != pos + 1 || at > order)
+            continue;
+        if (remaining[pos % cap].fetch_sub(1, std::memory_order_acq_rel) == 1)
+            retire(pos);
+    }
+    return true;
+}
+
+bool BroadcastRing::tryPop(std::vector<Value> &msg, size_t reader)
+{
+    if (reader >= readerCount)
+        return false;
+    const size_t pos = cursors[reader].pos.load(std::memory_order_relaxed);
+    if (pos == GONE)
+        return false;
+    if (sequence[pos % cap].load(std::memory_order_acquire) != pos + 1)
+        return false;
+    const Value *src = slot(pos);
+    const size_t len = (size_t)src[0].i;
+    std::atomic<size_t> &left = remaining[pos % cap];
+    cursors[reader].pos.store(pos + 1, std::memory_order_relaxed);
+    // Demais assinantes já copiaram (decremento depois da cópia): os valores passam a este sem cópia
+    if (left.load(std::memory_order_acquire) == 1)
+    {
+        msg.assign(src + 1, src + 1 + len);
+        left.store(0, std::memory_order_relaxed);
+        sequence[pos % cap].store(pos + cap, std::memory_order_release);
+        return true;
+    }
+    msg.clear();
+    for (size_t k = 0; k < len; ++k)
+        msg.push_back(copy_value(src[1 + k]));
+    if (left.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        retire(pos);
+    return true;
+}
+
+void BroadcastRing::retire(size_t pos)
+{
+    Value *src = slot(pos);
+    for (size_t k = 0; k < (size_t)src[0].i; ++k)
+        release_value(src[1 + k]);
+    sequence[pos % cap].store(pos + cap, std::memory_order_release);
+}
+
+bool BroadcastRing::empty(size_t reader) const
+{
+    if (reader >= readerCount)
+        return true;
+    const size_t pos = cursors[reader].pos.load(std::memory_order_relaxed);
+    if (pos == GONE)
+        return true;
+    return sequence[pos % cap].load(std::memory_order_acquire) != pos + 1;
+}
+
+size_t BroadcastRing::size() const
+{
+    const size_t end = enqueuePos.load(std::memory_order_acquire);
+    size_t oldest = end;
+    for (size_t r = 0; r < readerCount; ++r)
+        oldest = std::min(oldest, cursors[r].pos.load(std::memory_order_relaxed));
+    return end - oldest;
+}
+
+bool BroadcastRing::full() const
+{
+    const size_t pos = enqueuePos.load(std::memory_order_acquire);
+    return (long)sequence[pos % cap].load(std::memory_order_acquire) - (long)pos < 0;
+}
+
+BroadcastRing::~BroadcastRing()
+{
+    const size_t end = enqueuePos.load(std::memory_order_relaxed);
+    for (size_t pos = end > cap ? end - cap : 0; pos < end; ++pos)
+        if (sequence[pos % cap].load(std::memory_order_relaxed) == pos + 1)
+            retire(pos);
+}
@@ -0,0 +1,129 @@
+#include "channel_metrics.h"
+#include <algorithm>
+#include <iomanip>
+
+void WaitHistogram::record(unsigned long long ns)
+{
+    int bucket = 0;
+    while (bucket < BUCKETS - 1 && (ns >> bucket) > 1)
+        ++bucket;
+    buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    total.fetch_add(ns, std::memory_order_relaxed);
+    count.fetch_add(1, std::memory_order_relaxed);
+}
+
+void WaitHistogram::merge(const WaitHistogram &other)
+{
+    for (int k = 0; k < BUCKETS; ++k)
+        if (unsigned long long n = other.buckets[k].load(std::memory_order_relaxed))
+            buckets[k].fetch_add(n, std::memory_order_relaxed);
+    total.fetch_add(other.totalNs(), std::memory_order_relaxed);
+    count.fetch_add(other.samples(), std::memory_order_relaxed);
+}
+
+unsigned long long WaitHistogram::percentileNs(double p) const
+{
+    unsigned long long n = samples();
+    if (!n)
+        return 0;
+    // Menor balde que acumula ao menos p das amostras
+    unsigned long long want = (unsigned long long)(p * (double)n + 0.999999), seen = 0;
+    for (int k = 0; k < BUCKETS; ++k)
+    {
+        seen += buckets[k].load(std::memory_order_relaxed);
+        if (seen >= want)
+            return k >= 63 ? ~0ull : (2ull << k) - 1;
+    }
+    return ~0ull;
+}
+
+void ChannelMetrics::onSend(size_t depth)
+{
+    sent.fetch_add(1, std::memory_order_relaxed);
+    depthSum.fetch_add(depth, std::memory_order_relaxed);
+    unsigned long long peak = peakDepth.load(std::memory_order_relaxed);
+    while (depth > peak && !peakDepth.compare_exchange_weak(peak, depth, std::memory_order_relaxed))
+        ;
+}
+
+void ChannelMetrics::merge(const ChannelMetrics &other)
+{
+    sent.fetch_add(other.sent.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    received.fetch_add(other.received.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    depthSum.fetch_add(other.depthSum.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    unsigned long long theirs = other.peakDepth.load(std::memory_order_relaxed);
+    unsigned long long peak = peakDepth.load(std::memory_order_relaxed);
+    while (theirs > peak && !peakDepth.compare_exchange_weak(peak, theirs, std::memory_order_relaxed))
+        ;
+    sendBlocked.merge(other.sendBlocked);
+    recvBlocked.merge(other.recvBlocked);
+}
+
+double ChannelMetrics::averageDepth() const
+{
+    unsigned long long n = sent.load(std::memory_order_relaxed);
+    return n ? (double)depthSum.load(std::memory_order_relaxed) / (double)n : 0.0;
+}
+
+static std::string json_string(const std::string &text)
+{
+    std::string out = "\"";
+    for (char c : text)
+    {
+        if (c == '"' || c == '\\')
+            out += '\\';
+        out += c;
+    }
+    return out + "\"";
+}
+
+void print_channel_metrics(std::vector<ChannelMetricsRow> rows, MetricsFormat format, const std::string &component,
+                           std::ostream &out)
+{
+    std::sort(rows.begin(), rows.end(), [](const ChannelMetricsRow &a, const ChannelMetricsRow &b)
+              { return a.name < b.name; });
+    std::ios::fmtflags flags = out.flags();
+    std::streamsize precision = out.precision();
+    out << std::fixed << std::setprecision(2);
+    if (format == MetricsFormat::JSON)
+    {
+        out << "{";
+        if (!component.empty())
+            out << "\"component\":" << json_string(component) << ",";
+        out << "\"channels\":[";
+        for (size_t k = 0; k < rows.size(); ++k)
+        {
+            const ChannelMetrics &m = *rows[k].metrics;
+            out << (k ? "," : "") << "{\"channel\":" << json_string(rows[k].name)
+                << ",\"kind\":" << json_string(rows[k].kind) << ",\"sent\":" << m.sent.load()
+                << ",\"received\":" << m.received.load() << ",\"peak_depth\":" << m.peakDepth.load()
+                << ",\"avg_depth\":" << m.averageDepth() << ",\"send_blocked_ns\":" << m.sendBlocked.totalNs()
+                << ",\"send_blocked_p99_ns\":" << m.sendBlocked.percentileNs(0.99)
+                << ",\"recv_blocked_ns\":" << m.recvBlocked.totalNs()
+                << ",\"recv_blocked_p99_ns\":" << m.recvBlocked.percentileNs(0.99) << "}";
+        }
+        out << "]}\n";
+    }
+    else
+    {
+        size_t nameWidth = 7;
+        for (const auto &row : rows)
+            nameWidth = std::max(nameWidth, row.name.size());
+        out << std::left << std::setw((int)nameWidth) << "channel" << std::right << std::setw(10) << "kind"
+            << std::setw(10) << "sent" << std::setw(10) << "received" << std::setw(7) << "peak" << std::setw(9)
+            << "avg" << std::setw(14) << "send_blk_ms" << std::setw(14) << "send_p99_us" << std::setw(14)
+            << "recv_blk_ms" << std::setw(14) << "recv_p99_us" << "\n";
+        for (const auto &row : rows)
+        {
+            const ChannelMetrics &m = *row.metrics;
+            out << std::left << std::setw((int)nameWidth) << row.name << std::right << std::setw(10) << row.kind
+                << std::setw(10) << m.sent.load() << std::setw(10) << m.received.load() << std::setw(7)
+                << m.peakDepth.load() << std::setw(9) << m.averageDepth() << std::setw(14)
+                << m.sendBlocked.totalNs() / 1e6 << std::setw(14) << m.sendBlocked.percentileNs(0.99) / 1e3
+                << std::setw(14) << m.recvBlocked.totalNs() / 1e6 << std::setw(14)
+                << m.recvBlocked.percentileNs(0.99) / 1e3 << "\n";
+        }
+    }
+    out.flags(flags);
+    out.precision(precision);
+}
@@ -0,0 +1,144 @@
+#include "message_codec.h"
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+static void put_u32(std::vector<unsigned char> &out, uint32_t v)
+{
+    for (int k = 0; k < 4; ++k)
+        out.push_back((unsigned char)(v >> (8 * k)));
+}
+
+static void put_value(std::vector<unsigned char> &out, const Value &v)
+{
+    out.push_back((unsigned char)v.tag);
+    switch (v.tag)
+    {
+    case Value::INT:
+        put_u32(out, (uint32_t)v.i);
+        break;
+    case Value::FLOAT:
+    {
+        uint64_t bits;
+        std::memcpy(&bits, &v.f, sizeof bits);
+        put_u32(out, (uint32_t)bits);
+        put_u32(out, (uint32_t)(bits >> 32));
+        break;
+    }
+    case Value::STR:
+        put_u32(out, (uint32_t)v.s->size());
+        out.insert(out.end(), v.s->begin(), v.s->end());
+        break;
+    case Value::ARRAY:
+        put_u32(out, (uint32_t)v.a->elems.size());
+        for (const Value &e : v.a->elems)
+            put_value(out, e);
+        break;
+    default:
+        break;
+    }
+}
+
+void encode_message(const Value *msg, size_t len, std::vector<unsigned char> &out)
+{
+    put_u32(out, (uint32_t)len);
+    for (size_t k = 0; k < len; ++k)
+        put_value(out, msg[k]);
+}
+
+namespace
+{
+    // Leitura com limite: qualquer acesso além do fim marca a entrada como inválida
+    struct Reader
+    {
+        const unsigned char *p;
+        const unsigned char *end;
+        bool ok = true;
+
+        uint32_t u32()
+        {
+            if (end - p < 4)
+            {
+                ok = false;
+                return 0;
+            }
+            uint32_t v = (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+            p += 4;
+            return v;
+        }
+
+        Value value(int depth)
+        {
+            if (p == end || depth > 64)
+            {
+                ok = false;
+                return Value();
+            }
+            unsigned char tag = *p++;
+            switch (tag)
+            {
+            case Value::NONE:
+                return Value();
+            case Value::INT:
+                return Value::ofInt((int)u32());
+            case Value::FLOAT:
+            {
+                uint64_t bits = u32();
+                bits |= (uint64_t)u32() << 32;
+                double f;
+                std::memcpy(&f, &bits, sizeof f);
+                return Value::ofFloat(f);
+            }
+            case Value::STR:
+            {
+                uint32_t n = u32();
+                if (!ok || (size_t)(end - p) < n)
+                {
+                    ok = false;
+                    return Value();
+                }
+                const std::string *s = intern_string(std::string((const char *)p, n));
+                p += n;
+                return Value::ofStr(s);
+            }
+            case Value::ARRAY:
+            {
+                uint32_t n = u32();
+                // Cada elemento ocupa ao menos um byte: limita a reserva a dados que existem
+                if (!ok || (size_t)(end - p) < n)
+                {
+                    ok = false;
+                    return Value();
+                }
+                ArrayObj *arr = new ArrayObj();
+                arr->elems.reserve(n);
+                for (uint32_t k = 0; k < n && ok; ++k)
+                    arr->elems.push_back(value(depth + 1));
+                Value v = Value::ofArray(arr);
+                if (ok)
+                    return v;
+                release_value(v);
+                return Value();
+            }
+            default:
+                ok = false;
+                return Value();
+            }
+        }
+    };
+}
+
+bool decode_message(const unsigned char *data, size_t size, std::vector<Value> &msg)
+{
+    Reader in{data, data + size};
+    uint32_t n = in.u32();
+    msg.clear();
+    for (uint32_t k = 0; k < n && in.ok; ++k)
+        msg.push_back(in.value(0));
+    if (in.ok && in.p == in.end)
+        return true;
+    for (Value &v : msg)
+        release_value(v);
+    msg.clear();
+    return false;
+}
@@ -0,0 +1,66 @@
+#include "message_ring.h"
+#include <algorithm>
+
+MessageRing::MessageRing(size_t arity, size_t capacity, size_t limit)
+    : width(arity), capacity(std::max<size_t>(1, limit ? std::min(capacity, limit) : capacity)), limit(limit)
+{
+    buf.assign(this->capacity * (width + 1), Value());
+}
+
+MessageRing::MessageRing(MessageRing &&other) noexcept
+    : buf(std::move(other.buf)), width(other.width), capacity(other.capacity), limit(other.limit),
+      head(other.head), count(other.count)
+{
+    other.count = 0;
+}
+
+MessageRing::~MessageRing()
+{
+    std::vector<Value> msg;
+    while (pop(msg))
+        for (auto &v : msg)
+            release_value(v);
+}
+
+void MessageRing::relayout(size_t newWidth, size_t newCapacity)
+{
+    // Move as mensagens em ordem para o início do novo buffer (Value é copiável bit a bit)
+    std::vector<Value> next(newCapacity * (newWidth + 1));
+    for (size_t k = 0; k < count; ++k)
+    {
+        const Value *src = slot((head + k) % capacity);
+        std::copy(src, src + 1 + src[0].i, next.data() + k * (newWidth + 1));
+    }
+    buf.swap(next);
+    width = newWidth;
+    capacity = newCapacity;
+    head = 0;
+}
+
+bool MessageRing::push(Value *msg, size_t len)
+{
+    if (full())
+        return false;
+    // Aridade desconhecida (canal sem declaração analisada) ou mensagem maior: alarga as posições
+    if (len > width || count == capacity)
+    {
+        size_t grown = count == capacity ? capacity * 2 : capacity;
+        relayout(std::max(width, len), limit ? std::min(grown, limit) : grown);
+    }
+    Value *dst = slot((head + count) % capacity);
+    dst[0] = Value::ofInt((int)len);
+    std::copy(msg, msg + len, dst + 1);
+    ++count;
+    return true;
+}
+
+bool MessageRing::pop(std::vector<Value> &msg)
+{
+    if (count == 0)
+        return false;
+    const Value *src = slot(head);
+    msg.assign(src + 1, src + 1 + src[0].i);
+    head = (head + 1) % capacity;
+    --count;
+    return true;
+}
@@ -0,0 +1,71 @@
+#include "mpmc_queue.h"
+#include <algorithm>
+
+MpmcQueue::MpmcQueue(size_t arity, size_t capacity) : width(arity), cap(capacity ? capacity : 1)
+{
+    buf.assign(cap * (width + 1), Value());
+    sequence.reset(new std::atomic<size_t>[cap]);
+    for (size_t k = 0; k < cap; ++k)
+        sequence[k].store(k, std::memory_order_relaxed);
+}
+
+bool MpmcQueue::tryPush(Value *msg, size_t len)
+{
+    size_t pos = enqueuePos.load(std::memory_order_relaxed);
+    for (;;)
+    {
+        // seq == pos: posição livre nesta volta; seq < pos: ainda não consumida (fila cheia)
+        const size_t seq = sequence[pos % cap].load(std::memory_order_acquire);
+        const long diff = (long)seq - (long)pos;
+        if (diff == 0)
+        {
+            if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                break;
+        }
+        else if (diff < 0)
+            return false;
+        else
+            pos = enqueuePos.load(std::memory_order_relaxed);
+    }
+    for (size_t k = width; k < len; ++k)
+        release_value(msg[k]);
+    len = std::min(len, width);
+    Value *dst = slot(pos);
+    dst[0] = Value::ofInt((int)len);
+    std::copy(msg, msg + len, dst + 1);
+    sequence[pos % cap].store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+bool MpmcQueue::tryPop(std::vector<Value> &msg)
+{
+    size_t pos = dequeuePos.load(std::memory_order_relaxed);
+    for (;;)
+    {
+        // seq == pos + 1: mensagem publicada; menor: produtor ainda não chegou (fila vazia)
+        const size_t seq = sequence[pos % cap].load(std::memory_order_acquire);
+        const long diff = (long)seq - (long)(pos + 1);
+        if (diff == 0)
+        {
+            if (dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                break;
+        }
+        else if (diff < 0)
+            return false;
+        else
+            pos = dequeuePos.load(std::memory_order_relaxed);
+    }
+    const Value *src = slot(pos);
+    msg.assign(src + 1, src + 1 + src[0].i);
+    // Libera a posição para a próxima volta do produtor
+    sequence[pos % cap].store(pos + cap, std::memory_order_release);
+    return true;
+}
+
+MpmcQueue::~MpmcQueue()
+{
+    std::vector<Value> msg;
+    while (tryPop(msg))
+        for (auto &v : msg)
+            release_value(v);
+}
@@ -0,0 +1,153 @@
+#include "shared_channel.h"
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+SharedChannel::SharedChannel(ChannelKind kind, size_t arity, size_t capacity) : width(arity), limit(capacity)
+{
+    // Anel só até RING_SLOTS: capacidade declarada maior não aloca tudo de uma vez
+    const size_t slots = capacity ? std::min(capacity, RING_SLOTS) : RING_SLOTS;
+    spillLimit = capacity ? capacity - slots : SIZE_MAX;
+    if (kind == ChannelKind::SPSC)
+        spsc.reset(new SpscRing(arity, slots));
+    else if (kind == ChannelKind::BROADCAST)
+        bcast.reset(new BroadcastRing(arity, slots));
+    else
+        mpmc.reset(new MpmcQueue(arity, slots));
+    // Com um único núcleo o outro lado não avança enquanto giramos: vai direto para as cessões
+    if (std::thread::hardware_concurrency() <= 1)
+        waitPolicy.spins = 0;
+}
+
+SharedChannel::SharedChannel(std::unique_ptr<RemoteChannel> endpoint) : link(std::move(endpoint))
+{
+    if (std::thread::hardware_concurrency() <= 1)
+        waitPolicy.spins = 0;
+}
+
+SharedChannel::~SharedChannel()
+{
+    for (auto &entry : spill)
+        for (auto &v : entry.msg)
+            release_value(v);
+}
+
+void SharedChannel::beginBroadcast(size_t readers)
+{
+    if (!bcast)
+        return;
+    bcast->reset(readers);
+    // Como no anel: o que algum assinante do bloco anterior não recebeu é entregue a todos os novos
+    std::lock_guard<std::mutex> lock(spillMutex);
+    for (auto &entry : spill)
+        entry.left = readers;
+    spillNext.assign(std::max(readers, (size_t)1), spillBase);
+    spillGone = 0;
+}
+
+void SharedChannel::leave(size_t reader)
+{
+    // Último assinante a sair não libera nada (ver BroadcastRing::leave); o transbordo segue o anel
+    if (!bcast || !bcast->leave(reader))
+        return;
+    std::lock_guard<std::mutex> lock(spillMutex);
+    if (reader >= spillNext.size() || reader >= bcast->subscribers() || spillNext[reader] == SIZE_MAX)
+        return;
+    // Toda entrada ainda não lida foi gravada antes da saída (push e leave sob o mesmo lock): conta com ele
+    for (size_t at = spillNext[reader] - spillBase; at < spill.size(); ++at)
+        --spill[at].left;
+    spillNext[reader] = SIZE_MAX;
+    ++spillGone;
+    while (!spill.empty() && spill.front().left == 0)
+    {
+        for (auto &v : spill.front().msg)
+            release_value(v);
+        spill.pop_front();
+        ++spillBase;
+    }
+    spilled.store(spill.size(), std::memory_order_release);
+}
+
+bool SharedChannel::spillPush(Value *msg, size_t len)
+{
+    if (!spillLimit)
+        return false;
+    std::lock_guard<std::mutex> lock(spillMutex);
+    if (spill.size() >= spillLimit)
+        return false;
+    // Mesmo corte do anel: valores além da aridade são descartados
+    for (size_t k = width; k < len; ++k)
+        release_value(msg[k]);
+    spill.emplace_back();
+    spill.back().msg.assign(msg, msg + std::min(len, width));
+    spill.back().left = bcast ? bcast->subscribers() - spillGone : 1;
+    spilled.store(spill.size(), std::memory_order_release);
+    return true;
+}
+
+bool SharedChannel::spillPop(std::vector<Value> &msg, size_t reader)
+{
+    std::lock_guard<std::mutex> lock(spillMutex);
+    if (!bcast)
+    {
+        if (spill.empty())
+            return false;
+        msg.swap(spill.front().msg);
+        spill.pop_front();
+        spilled.store(spill.size(), std::memory_order_release);
+        return true;
+    }
+    if (reader >= spillNext.size() || reader >= bcast->subscribers() || spillNext[reader] == SIZE_MAX)
+        return false;
+    const size_t at = spillNext[reader] - spillBase;
+    if (at >= spill.size())
+        return false;
+    Spilled &entry = spill[at];
+    // Último assinante leva os valores; os demais recebem cópias (arrays por referência)
+    if (entry.left == 1)
+        msg.swap(entry.msg);
+    else
+    {
+        msg.clear();
+        for (const auto &v : entry.msg)
+            msg.push_back(copy_value(v));
+    }
+    --entry.left;
+    ++spillNext[reader];
+    while (!spill.empty() && spill.front().left == 0)
+    {
+        for (auto &v : spill.front().msg)
+            release_value(v);
+        spill.pop_front();
+        ++spillBase;
+    }
+    spilled.store(spill.size(), std::memory_order_release);
+    return true;
+}
+
+bool SharedChannel::spillEmpty(size_t reader) const
+{
+    std::lock_guard<std::mutex> lock(spillMutex);
+    if (!bcast)
+        return spill.empty();
+    return reader >= spillNext.size() || spillNext[reader] == SIZE_MAX || spillNext[reader] - spillBase >= spill.size();
+}
+
+void SharedChannel::addWaiter()
+{
+    waiters.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+}
+
+bool SharedChannel::needsWake() const
+{
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    return waiters.load(std::memory_order_relaxed) > 0;
+}
+
+unsigned long long SharedChannel::nowNs()
+{
+    return (unsigned long long)std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
@@ -0,0 +1,168 @@
+#include "shm_channel.h"
+#include "message_codec.h"
+#include <algorithm>
+#include <cstring>
+#include <new>
+#include <sys/mman.h>
+
+static size_t round64(size_t n) { return (n + 63) & ~(size_t)63; }
+
+ShmRing::ShmRing(void *base, size_t bytes)
+    : hdr(static_cast<ShmRingHeader *>(base)),
+      data(static_cast<unsigned char *>(base) + round64(sizeof(ShmRingHeader))), size(bytes) {}
+
+void ShmRing::copyIn(uint64_t pos, const unsigned char *src, size_t len)
+{
+    size_t at = (size_t)(pos % size);
+    size_t first = std::min(len, size - at);
+    std::memcpy(data + at, src, first);
+    std::memcpy(data, src + first, len - first);
+}
+
+void ShmRing::copyOut(uint64_t pos, unsigned char *dst, size_t len) const
+{
+    size_t at = (size_t)(pos % size);
+    size_t first = std::min(len, size - at);
+    std::memcpy(dst, data + at, first);
+    std::memcpy(dst + first, data, len - first);
+}
+
+bool ShmRing::tryWrite(const unsigned char *frame, size_t len)
+{
+    const uint64_t t = hdr->tail.load(std::memory_order_relaxed);
+    const uint64_t sent = hdr->sent.load(std::memory_order_relaxed);
+    if (sent - hdr->received.load(std::memory_order_acquire) >= hdr->limit)
+        return false;
+    if (t - hdr->head.load(std::memory_order_acquire) + 4 + len > size)
+        return false;
+    unsigned char prefix[4];
+    for (int k = 0; k < 4; ++k)
+        prefix[k] = (unsigned char)((uint32_t)len >> (8 * k));
+    copyIn(t, prefix, 4);
+    copyIn(t + 4, frame, len);
+    // Publica bytes antes da contagem: quem vê a mensagem contada já vê o quadro
+    hdr->tail.store(t + 4 + len, std::memory_order_release);
+    hdr->sent.store(sent + 1, std::memory_order_release);
+    return true;
+}
+
+bool ShmRing::tryRead(std::vector<unsigned char> &frame)
+{
+    const uint64_t h = hdr->head.load(std::memory_order_relaxed);
+    if (h == hdr->tail.load(std::memory_order_acquire))
+        return false;
+    unsigned char prefix[4];
+    copyOut(h, prefix, 4);
+    size_t len = (size_t)prefix[0] | (size_t)prefix[1] << 8 | (size_t)prefix[2] << 16 | (size_t)prefix[3] << 24;
+    frame.resize(len);
+    copyOut(h + 4, frame.data(), len);
+    hdr->head.store(h + 4 + len, std::memory_order_release);
+    hdr->received.store(hdr->received.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    return true;
+}
+
+ShmSegment::ShmSegment(size_t rings, size_t ringBytes)
+    : count(rings), stride(round64(sizeof(ShmRingHeader)) + round64(ringBytes)), bytes(round64(ringBytes))
+{
+    if (rings == 0)
+        return;
+    void *p = mmap(nullptr, rings * stride, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED)
+        return;
+    base = static_cast<unsigned char *>(p);
+    mapped = rings * stride;
+    for (size_t k = 0; k < rings; ++k)
+    {
+        ShmRingHeader *hdr = new (base + k * stride) ShmRingHeader();
+        hdr->limit = UINT64_MAX;
+    }
+}
+
+ShmSegment::~ShmSegment()
+{
+    // Mensagens ainda nos anéis são só bytes: nada a liberar além do mapeamento
+    if (base)
+        munmap(base, mapped);
+}
+
+ShmRing ShmSegment::ring(size_t k) const
+{
+    return ShmRing(base + k * stride, bytes);
+}
+
+ShmChannel::ShmChannel(size_t arity, std::vector<ShmRing> inbound, std::vector<ShmRing> outbound)
+    : width(arity), in(std::move(inbound)), out(std::move(outbound)) {}
+
+bool ShmChannel::tryPush(Value *msg, size_t len)
+{
+    if (out.empty())
+        return false;
+    std::lock_guard<std::mutex> lock(sendLock);
+    len = std::min(len, width);
+    sendBuf.clear();
+    encode_message(msg, len, sendBuf);
+    ShmRing &ring = out.front();
+    // Quadro que nunca caberia no anel travaria o canal: descartado e contado
+    bool fits = sendBuf.size() + 4 <= ring.dataBytes();
+    if (fits && !ring.tryWrite(sendBuf.data(), sendBuf.size()))
+        return false;
+    if (!fits)
+        ++dropped;
+    for (size_t k = 0; k < len; ++k)
+        release_value(msg[k]);
+    return true;
+}
+
+bool ShmChannel::tryPop(std::vector<Value> &msg)
+{
+    std::lock_guard<std::mutex> lock(recvLock);
+    // Rodízio entre emissores: um componente sempre pronto não deixa os demais sem vez
+    for (size_t j = 0; j < in.size(); ++j)
+    {
+        size_t k = (turn + j) % in.size();
+        if (!in[k].tryRead(recvBuf))
+            continue;
+        turn = k + 1;
+        if (decode_message(recvBuf.data(), recvBuf.size(), msg))
+            return true;
+        // Quadro corrompido (não deveria ocorrer): entrega mensagem vazia, que não se liga a variáveis
+        msg.clear();
+        return true;
+    }
+    return false;
+}
+
+bool ShmChannel::empty() const
+{
+    for (const ShmRing &ring : in)
+        if (!ring.empty())
+            return false;
+    return true;
+}
+
+size_t ShmChannel::depth() const
+{
+    size_t n = 0;
+    for (const auto *rings : {&in, &out})
+        for (const ShmRing &ring : *rings)
+            n += ring.header().sent.load(std::memory_order_acquire) - ring.header().received.load(std::memory_order_acquire);
+    return n;
+}
+
+bool ShmChannel::full() const
+{
+    return out.empty() || out.front().full();
+}
+
+bool ShmChannel::writersGone() const
+{
+    for (const ShmRing &ring : in)
+        if (!ring.header().writerGone.load(std::memory_order_acquire))
+            return false;
+    return true;
+}
+
+bool ShmChannel::readerGone() const
+{
+    return out.empty() || out.front().header().readerGone.load(std::memory_order_acquire);
+}
@@ -0,0 +1,236 @@
+#include "socket_channel.h"
+#include "message_codec.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+static void set_nonblocking(int fd)
+{
+    int flags = fcntl(fd, F_GETFL, 0);
+    if (flags >= 0)
+        fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+}
+
+SocketChannel::SocketChannel(size_t arity, int listenFd, const std::string &peerPath,
+                             std::vector<const std::atomic<int> *> writerGone, const std::atomic<int> *readerGone)
+    : width(arity), listenFd(listenFd), writerFlags(std::move(writerGone)), readerFlag(readerGone)
+{
+    if (peerPath.empty())
+        return;
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (peerPath.size() >= sizeof addr.sun_path)
+        return;
+    std::memcpy(addr.sun_path, peerPath.c_str(), peerPath.size() + 1);
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0)
+        return;
+    // Conexão bloqueante: o socket de escuta já existe (criado pelo pai), então só espera vaga no backlog
+    int rc;
+    while ((rc = connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof addr)) < 0 && errno == EINTR)
+        ;
+    if (rc < 0)
+    {
+        close(fd);
+        return;
+    }
+    set_nonblocking(fd);
+    outFd = fd;
+}
+
+SocketChannel::~SocketChannel()
+{
+    finish();
+    // Lote restante: espera o socket aceitar enquanto o receptor existir
+    while (outFd >= 0 && sendPending() && sentAt < batch.size() && !readerGone())
+    {
+        pollfd p{outFd, POLLOUT, 0};
+        poll(&p, 1, 100);
+    }
+    if (outFd >= 0)
+        close(outFd);
+}
+
+bool SocketChannel::sendPending()
+{
+    while (sentAt < batch.size())
+    {
+        ssize_t n = send(outFd, batch.data() + sentAt, batch.size() - sentAt, MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (n > 0)
+        {
+            sentAt += (size_t)n;
+            continue;
+        }
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            break;
+        broken = true; // EPIPE/ECONNRESET: o receptor fechou
+        return false;
+    }
+    if (sentAt == batch.size())
+    {
+        batch.clear();
+        sentAt = 0;
+    }
+    else if (sentAt > BATCH_BYTES && sentAt * 2 > batch.size())
+    {
+        batch.erase(batch.begin(), batch.begin() + (std::ptrdiff_t)sentAt);
+        sentAt = 0;
+    }
+    return true;
+}
+
+bool SocketChannel::tryPush(Value *msg, size_t len)
+{
+    std::lock_guard<std::mutex> lock(sendLock);
+    if (outFd < 0 || broken)
+        return false;
+    if (batch.size() - sentAt >= MAX_PENDING && (!sendPending() || batch.size() - sentAt >= MAX_PENDING))
+        return false;
+    len = std::min(len, width);
+    // Tamanho do quadro preenchido depois de codificar a mensagem direto no lote
+    size_t start = batch.size();
+    batch.resize(start + 4);
+    encode_message(msg, len, batch);
+    uint32_t size = (uint32_t)(batch.size() - start - 4);
+    for (int k = 0; k < 4; ++k)
+        batch[start + k] = (unsigned char)(size >> (8 * k));
+    for (size_t k = 0; k < len; ++k)
+        release_value(msg[k]);
+    if (batch.size() - sentAt >= BATCH_BYTES)
+        sendPending();
+    return true;
+}
+
+void SocketChannel::flush()
+{
+    std::lock_guard<std::mutex> lock(sendLock);
+    if (outFd >= 0 && !broken)
+        sendPending();
+}
+
+bool SocketChannel::frameReady(const Inbound &conn) const
+{
+    if (conn.buf.size() - conn.at < 4)
+        return false;
+    const unsigned char *p = conn.buf.data() + conn.at;
+    size_t size = (size_t)p[0] | (size_t)p[1] << 8 | (size_t)p[2] << 16 | (size_t)p[3] << 24;
+    return conn.buf.size() - conn.at - 4 >= size;
+}
+
+bool SocketChannel::tryPop(std::vector<Value> &msg)
+{
+    std::lock_guard<std::mutex> lock(recvLock);
+    if (listenFd < 0)
+        return false;
+    // Quadros já lidos saem sem chamada de sistema; só então aceita conexões novas e lê dos sockets
+    if (popBuffered(msg))
+        return true;
+    for (;;)
+    {
+        int fd = accept(listenFd, nullptr, nullptr);
+        if (fd < 0)
+            break;
+        set_nonblocking(fd);
+        in.push_back(Inbound{fd, {}, 0});
+    }
+    for (Inbound &conn : in)
+    {
+        if (conn.at == conn.buf.size())
+        {
+            conn.buf.clear();
+            conn.at = 0;
+        }
+        // Lê até completar um quadro ou o socket esvaziar (quadro grande chega em vários pedaços)
+        while (!frameReady(conn) && conn.fd >= 0)
+        {
+            unsigned char chunk[65536];
+            ssize_t n = read(conn.fd, chunk, sizeof chunk);
+            if (n > 0)
+                conn.buf.insert(conn.buf.end(), chunk, chunk + n);
+            else if (n == 0)
+            {
+                close(conn.fd); // emissor encerrou: o que restou no buffer ainda é entregue
+                conn.fd = -1;
+            }
+            else if (errno != EINTR)
+                break;
+        }
+    }
+    return popBuffered(msg);
+}
+
+bool SocketChannel::popBuffered(std::vector<Value> &msg)
+{
+    // Rodízio entre conexões com quadro completo no buffer
+    for (size_t j = 0; j < in.size(); ++j)
+    {
+        Inbound &conn = in[(turn + j) % in.size()];
+        if (!frameReady(conn))
+            continue;
+        turn = (turn + j + 1) % in.size();
+        const unsigned char *p = conn.buf.data() + conn.at;
+        size_t size = (size_t)p[0] | (size_t)p[1] << 8 | (size_t)p[2] << 16 | (size_t)p[3] << 24;
+        if (!decode_message(p + 4, size, msg))
+            msg.clear(); // quadro corrompido: mensagem vazia não se liga a variáveis
+        conn.at += 4 + size;
+        return true;
+    }
+    return false;
+}
+
+bool SocketChannel::empty() const
+{
+    // Consulta aproximada: quadro já no buffer, conexão pendente ou bytes no socket contam como mensagem
+    std::vector<pollfd> watch;
+    for (const Inbound &conn : in)
+    {
+        if (frameReady(conn))
+            return false;
+        if (conn.fd >= 0)
+            watch.push_back(pollfd{conn.fd, POLLIN, 0});
+    }
+    if (listenFd >= 0)
+        watch.push_back(pollfd{listenFd, POLLIN, 0});
+    return watch.empty() || poll(watch.data(), watch.size(), 0) <= 0;
+}
+
+bool SocketChannel::full() const
+{
+    return outFd < 0 || batch.size() - sentAt >= MAX_PENDING;
+}
+
+bool SocketChannel::writersGone() const
+{
+    for (const std::atomic<int> *flag : writerFlags)
+        if (!flag->load(std::memory_order_acquire))
+            return false;
+    return true;
+}
+
+bool SocketChannel::readerGone() const
+{
+    return outFd < 0 || broken || (readerFlag && readerFlag->load(std::memory_order_acquire));
+}
+
+void SocketChannel::finish()
+{
+    std::lock_guard<std::mutex> lock(recvLock);
+    for (Inbound &conn : in)
+        if (conn.fd >= 0)
+        {
+            close(conn.fd);
+            conn.fd = -1;
+        }
+    in.clear();
+    if (listenFd >= 0)
+        close(listenFd); // cópia herdada; o pai mantém a sua para os próximos blocos PAR
+    listenFd = -1;
+}
@@ -0,0 +1,58 @@
+#include "spsc_ring.h"
+#include <algorithm>
+
+static size_t round_pow2(size_t n)
+{
+    size_t p = 1;
+    while (p < n)
+        p <<= 1;
+    return p;
+}
+
+SpscRing::SpscRing(size_t arity, size_t capacity)
+    : width(arity), mask(round_pow2(capacity ? capacity : 1) - 1), limit(capacity ? capacity : 1)
+{
+    buf.assign((mask + 1) * (width + 1), Value());
+}
+
+bool SpscRing::tryPush(Value *msg, size_t len)
+{
+    const size_t t = tail.load(std::memory_order_relaxed);
+    if (t - cachedHead >= limit)
+    {
+        cachedHead = head.load(std::memory_order_acquire);
+        if (t - cachedHead >= limit)
+            return false;
+    }
+    for (size_t k = width; k < len; ++k)
+        release_value(msg[k]);
+    len = std::min(len, width);
+    Value *dst = slot(t);
+    dst[0] = Value::ofInt((int)len);
+    std::copy(msg, msg + len, dst + 1);
+    tail.store(t + 1, std::memory_order_release);
+    return true;
+}
+
+bool SpscRing::tryPop(std::vector<Value> &msg)
+{
+    const size_t h = head.load(std::memory_order_relaxed);
+    if (h == cachedTail)
+    {
+        cachedTail = tail.load(std::memory_order_acquire);
+        if (h == cachedTail)
+            return false;
+    }
+    const Value *src = slot(h);
+    msg.assign(src + 1, src + 1 + src[0].i);
+    head.store(h + 1, std::memory_order_release);
+    return true;
+}
+
+SpscRing::~SpscRing()
+{
+    std::vector<Value> msg;
+    while (tryPop(msg))
+        for (auto &v : msg)
+            release_value(v);
+}
@@ -0,0 +1,333 @@
+#include "component_processes.h"
+#include "socket_channel.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <poll.h>
+#include <cstdlib>
+#include <fcntl.h>
+#include <sched.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+static size_t total_rings(const ComponentLayout &layout)
+{
+    size_t n = 0;
+    for (const auto &cross : layout.channels)
+        n += cross.senders.size();
+    return n;
+}
+
+// Socket de escuta não bloqueante em path; -1 se falhar
+static int listen_unix(const std::string &path)
+{
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof addr.sun_path)
+        return -1;
+    std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0)
+        return -1;
+    if (bind(fd, reinterpret_cast<sockaddr *>(&addr), sizeof addr) < 0 || listen(fd, SOMAXCONN) < 0)
+    {
+        close(fd);
+        return -1;
+    }
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+    return fd;
+}
+
+ComponentChannels::ComponentChannels(const ComponentLayout &layout,
+                                     const std::unordered_map<std::string, int> &capacities,
+                                     ChannelTransport transport)
+    : channels(layout.channels), transport(transport),
+      segment(total_rings(layout), transport == ChannelTransport::SHM ? RING_BYTES : 0)
+{
+    if (transport == ChannelTransport::SOCKET && !channels.empty())
+    {
+        const char *tmp = std::getenv("TMPDIR");
+        std::string pattern = std::string(tmp && *tmp ? tmp : "/tmp") + "/minipar-XXXXXX";
+        std::vector<char> dir(pattern.begin(), pattern.end());
+        dir.push_back('\0');
+        if (mkdtemp(dir.data()))
+            socketDir = dir.data();
+    }
+    for (const auto &cross : channels)
+    {
+        int fd = -1;
+        std::string path;
+        if (transport == ChannelTransport::SOCKET && cross.hasReceiver && !socketDir.empty())
+        {
+            path = socketDir + "/" + cross.name + ".sock";
+            if ((fd = listen_unix(path)) < 0)
+                break; // valid() fica falso
+        }
+        listenFds.push_back(fd);
+        socketPaths.push_back(path);
+    }
+    size_t next = 0;
+    for (const auto &cross : channels)
+    {
+        firstRing.push_back(next);
+        auto capacity = capacities.find(cross.name);
+        // Sem capacidade declarada, só o espaço do anel limita (o emissor espera o receptor consumir)
+        for (size_t k = 0; k < cross.senders.size() && segment.valid(); ++k)
+            segment.ring(next + k).header().limit = capacity != capacities.end() && capacity->second > 0
+                                                        ? (uint64_t)capacity->second
+                                                        : UINT64_MAX;
+        next += cross.senders.size();
+    }
+}
+
+ComponentChannels::~ComponentChannels()
+{
+    for (size_t c = 0; c < listenFds.size(); ++c)
+        if (listenFds[c] >= 0)
+        {
+            close(listenFds[c]);
+            unlink(socketPaths[c].c_str());
+        }
+    if (!socketDir.empty())
+        rmdir(socketDir.c_str());
+}
+
+void ComponentChannels::attach(const std::string &component, const std::unordered_map<std::string, int> &arities,
+                               SharedChannelMap &map) const
+{
+    for (size_t c = 0; c < channels.size(); ++c)
+    {
+        const CrossChannel &cross = channels[c];
+        std::vector<ShmRing> in, out;
+        if (cross.hasReceiver && cross.receiver == component)
+            for (size_t k = 0; k < cross.senders.size(); ++k)
+                in.push_back(segment.ring(firstRing[c] + k));
+        for (size_t k = 0; k < cross.senders.size(); ++k)
+            if (cross.senders[k] == component)
+                out.push_back(segment.ring(firstRing[c] + k));
+        auto arity = arities.find(cross.name);
+        size_t width = (size_t)std::max(arity == arities.end() ? 0 : arity->second, 1);
+        std::unique_ptr<RemoteChannel> link;
+        if (transport == ChannelTransport::SHM)
+            link.reset(new ShmChannel(width, std::move(in), std::move(out)));
+        else
+        {
+            // Anéis servem só de marcas: de cada emissor (para o receptor) e do receptor (no anel deste emissor)
+            std::vector<const std::atomic<int> *> writers;
+            for (const ShmRing &ring : in)
+                writers.push_back(&ring.header().writerGone);
+            link.reset(new SocketChannel(width, in.empty() ? -1 : listenFds[c], out.empty() ? "" : socketPaths[c],
+                                         std::move(writers), out.empty() ? nullptr : &out.front().header().readerGone));
+        }
+        std::unique_ptr<SharedChannel> chan(new SharedChannel(std::move(link)));
+        auto old = map.find(cross.name);
+        if (old != map.end())
+            chan->setWaitPolicy(old->second->policy());
+        map[cross.name] = std::move(chan);
+    }
+}
+
+void ComponentChannels::beginBlock(const std::vector<std::string> &running)
+{
+    for (size_t c = 0; c < channels.size(); ++c)
+        for (size_t k = 0; k < channels[c].senders.size(); ++k)
+        {
+            ShmRingHeader &hdr = segment.ring(firstRing[c] + k).header();
+            hdr.writerGone.store(0, std::memory_order_release);
+            // Canal sem receptor em nenhum bloco: envio só bloqueia até o anel encher, depois descarta
+            hdr.readerGone.store(channels[c].hasReceiver ? 0 : 1, std::memory_order_release);
+        }
+    std::vector<std::string> idle;
+    for (const auto &cross : channels)
+    {
+        for (const auto &comp : cross.senders)
+            if (std::find(running.begin(), running.end(), comp) == running.end())
+                idle.push_back(comp);
+        if (cross.hasReceiver && std::find(running.begin(), running.end(), cross.receiver) == running.end())
+            idle.push_back(cross.receiver);
+    }
+    for (const auto &comp : idle)
+        markGone(comp);
+}
+
+void ComponentChannels::markGone(const std::string &component)
+{
+    for (size_t c = 0; c < channels.size(); ++c)
+        for (size_t k = 0; k < channels[c].senders.size(); ++k)
+        {
+            ShmRingHeader &hdr = segment.ring(firstRing[c] + k).header();
+            if (channels[c].senders[k] == component)
+                hdr.writerGone.store(1, std::memory_order_release);
+            if (channels[c].hasReceiver && channels[c].receiver == component)
+                hdr.readerGone.store(1, std::memory_order_release);
+        }
+}
+
+// Saída do filho no pipe: quadros [índice: u32][tamanho: u32][bytes]; índice UINT32_MAX = relatório
+static void put_frame(std::string &buf, uint32_t index, const std::string &text)
+{
+    uint32_t head[2] = {index, (uint32_t)text.size()};
+    buf.append(reinterpret_cast<const char *>(head), sizeof head);
+    buf.append(text);
+}
+
+static void write_all(int fd, const std::string &buf)
+{
+    size_t done = 0;
+    while (done < buf.size())
+    {
+        ssize_t n = write(fd, buf.data() + done, buf.size() - done);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return;
+        done += (size_t)n;
+    }
+}
+
+static bool run_child(const ComponentJob &job, size_t index, const ComponentBody &body, bool pinCores, int fd)
+{
+    if (pinCores)
+    {
+        long cores = sysconf(_SC_NPROCESSORS_ONLN);
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET((int)(index % (size_t)(cores > 0 ? cores : 1)), &set);
+        sched_setaffinity(0, sizeof set, &set);
+    }
+    std::vector<std::string> outputs;
+    std::string report;
+    bool ok = body(job, outputs, report);
+    std::string buf;
+    for (size_t k = 0; k < job.branches.size() && k < outputs.size(); ++k)
+        put_frame(buf, (uint32_t)job.branches[k], outputs[k]);
+    if (!report.empty())
+        put_frame(buf, UINT32_MAX, report);
+    write_all(fd, buf);
+    close(fd);
+    return ok;
+}
+
+bool run_component_processes(const std::vector<ComponentJob> &jobs, size_t branchCount, const ComponentBody &body,
+                             const std::function<void(const ComponentJob &)> &onExit, bool pinCores,
+                             std::vector<std::string> &outputs, std::vector<std::string> &reports, std::ostream &err)
+{
+    outputs.assign(branchCount, std::string());
+    reports.assign(jobs.size(), std::string());
+    std::vector<pid_t> pids(jobs.size(), -1);
+    std::vector<int> fds(jobs.size(), -1);
+    std::vector<std::string> raw(jobs.size());
+    bool ok = true;
+    for (size_t j = 0; j < jobs.size(); ++j)
+    {
+        int pipefd[2];
+        if (pipe(pipefd) != 0)
+        {
+            err << "[processos] pipe: " << std::strerror(errno) << "\n";
+            ok = false;
+            onExit(jobs[j]);
+            continue;
+        }
+        pid_t pid = fork();
+        if (pid == 0)
+        {
+            close(pipefd[0]);
+            // Pipes de leitura de irmãos herdados não interessam ao filho
+            for (size_t k = 0; k < j; ++k)
+                if (fds[k] >= 0)
+                    close(fds[k]);
+            // _exit: sem destrutores estáticos nem buffers herdados do pai
+            _exit(run_child(jobs[j], j, body, pinCores, pipefd[1]) ? 0 : 1);
+        }
+        close(pipefd[1]);
+        if (pid < 0)
+        {
+            err << "[processos] fork: " << std::strerror(errno) << "\n";
+            close(pipefd[0]);
+            ok = false;
+            onExit(jobs[j]);
+            continue;
+        }
+        pids[j] = pid;
+        fds[j] = pipefd[0];
+    }
+    // Lê todos os pipes enquanto os filhos rodam (pipe cheio travaria o filho); fim de arquivo = processo
+    // encerrado, inclusive por sinal: os outros componentes são liberados na hora
+    for (;;)
+    {
+        std::vector<pollfd> watch;
+        std::vector<size_t> owner;
+        for (size_t j = 0; j < jobs.size(); ++j)
+            if (fds[j] >= 0)
+            {
+                watch.push_back(pollfd{fds[j], POLLIN, 0});
+                owner.push_back(j);
+            }
+        if (watch.empty())
+            break;
+        if (poll(watch.data(), watch.size(), -1) < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            err << "[processos] poll: " << std::strerror(errno) << "\n";
+            return false;
+        }
+        for (size_t w = 0; w < watch.size(); ++w)
+        {
+            if (!watch[w].revents)
+                continue;
+            size_t j = owner[w];
+            char chunk[65536];
+            ssize_t n = read(fds[j], chunk, sizeof chunk);
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n > 0)
+            {
+                raw[j].append(chunk, (size_t)n);
+                continue;
+            }
+            close(fds[j]);
+            fds[j] = -1;
+            int status = 0;
+            while (waitpid(pids[j], &status, 0) < 0 && errno == EINTR)
+                ;
+            onExit(jobs[j]);
+            const std::string &name = jobs[j].component.empty() ? "-" : jobs[j].component;
+            if (WIFSIGNALED(status))
+            {
+                err << "[processos] componente '" << name << "' (pid " << pids[j] << ") terminou pelo sinal "
+                    << WTERMSIG(status) << "\n";
+                ok = false;
+            }
+            else if (WIFEXITED(status) && WEXITSTATUS(status) != 0)
+            {
+                err << "[processos] componente '" << name << "' (pid " << pids[j] << ") saiu com código "
+                    << WEXITSTATUS(status) << "\n";
+                ok = false;
+            }
+        }
+    }
+    for (size_t j = 0; j < jobs.size(); ++j)
+    {
+        const std::string &buf = raw[j];
+        size_t at = 0;
+        uint32_t head[2];
+        while (buf.size() - at >= sizeof head)
+        {
+            std::memcpy(head, buf.data() + at, sizeof head);
+            at += sizeof head;
+            if (buf.size() - at < head[1])
+                break; // quadro truncado (processo morreu escrevendo)
+            std::string text = buf.substr(at, head[1]);
+            at += head[1];
+            if (head[0] == UINT32_MAX)
+                reports[j] = std::move(text);
+            else if (head[0] < branchCount)
+                outputs[head[0]] = std::move(text);
+        }
+    }
+    return ok;
+}
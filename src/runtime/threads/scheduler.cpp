@@ -0,0 +1,260 @@
+#include "scheduler.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <thread>
+#include <unordered_set>
+
+// Worker corrente (para notify chamado de dentro de uma tarefa devolver a tarefa acordada ao mesmo deque)
+static thread_local const Scheduler *currentScheduler = nullptr;
+static thread_local size_t currentWorker = 0;
+
+static const unsigned POLL_INTERVAL = 64; // tarefa em sondagem passa à frente a cada tantas tomadas
+static const unsigned POLL_PAUSE_US = 50; // pausa antes de sondar quando não há mais nada a fazer
+
+Scheduler::Scheduler(size_t workers)
+{
+    if (workers == 0)
+        workers = ThreadPool::shared().size();
+    for (size_t k = 0; k < workers; ++k)
+        deques.push_back(std::unique_ptr<WorkDeque>(new WorkDeque()));
+}
+
+void Scheduler::enqueue(size_t me, GreenTask *task, bool front)
+{
+    queued.fetch_add(1);
+    std::lock_guard<std::mutex> lock(deques[me]->mtx);
+    if (front)
+        deques[me]->items.push_front(task);
+    else
+        deques[me]->items.push_back(task);
+}
+
+void Scheduler::push(size_t me, GreenTask *task, bool front)
+{
+    enqueue(me, task, front);
+    // Passa pelo mtx para não perder a notificação de um worker que acabou de ver a fila vazia
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+    }
+    idle.notify_one();
+}
+
+GreenTask *Scheduler::take(size_t me)
+{
+    // active sobe antes de queued descer: nenhum observador vê a tarefa em trânsito como inexistente
+    auto claim = [this](std::deque<GreenTask *> &items, bool back)
+    {
+        GreenTask *task = back ? items.back() : items.front();
+        if (back)
+            items.pop_back();
+        else
+            items.pop_front();
+        active.fetch_add(1);
+        queued.fetch_sub(1);
+        return task;
+    };
+    // 0. sondagem pendente de vez em quando passa à frente: não fica sem vez atrás de ramos que só cedem fatia
+    if (pollingCount.load(std::memory_order_relaxed) > 0 && ++deques[me]->sincePoll >= POLL_INTERVAL)
+    {
+        deques[me]->sincePoll = 0;
+        std::lock_guard<std::mutex> lock(mtx);
+        if (GreenTask *task = takePolling())
+            return task;
+    }
+    // 1. próprio deque, pelo fim (tarefa mais recente, cache quente)
+    {
+        std::lock_guard<std::mutex> lock(deques[me]->mtx);
+        if (!deques[me]->items.empty())
+            return claim(deques[me]->items, true);
+    }
+    // 2. roubo pelo início do deque dos outros workers
+    for (size_t k = 1; k < deques.size(); ++k)
+    {
+        WorkDeque &victim = *deques[(me + k) % deques.size()];
+        std::lock_guard<std::mutex> lock(victim.mtx);
+        if (!victim.items.empty())
+            return claim(victim.items, false);
+    }
+    // 3. tarefa nova da injeção
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (!injection.empty())
+        {
+            ++started;
+            peakStarted = std::max(peakStarted, started);
+            return claim(injection, false);
+        }
+    }
+    // 4. sondagem: nada mais a fazer, então uma pausa curta antes (evita girar a CPU esperando outro processo)
+    if (pollingCount.load(std::memory_order_relaxed) == 0)
+        return nullptr;
+    std::this_thread::sleep_for(std::chrono::microseconds(POLL_PAUSE_US));
+    deques[me]->sincePoll = 0;
+    std::lock_guard<std::mutex> lock(mtx);
+    return takePolling();
+}
+
+GreenTask *Scheduler::takePolling()
+{
+    if (polling.empty())
+        return nullptr;
+    GreenTask *task = polling.front();
+    polling.pop_front();
+    pollingCount.fetch_sub(1);
+    active.fetch_add(1);
+    queued.fetch_sub(1);
+    return task;
+}
+
+void Scheduler::execute(size_t me, GreenTask *task)
+{
+    switch (task->step())
+    {
+    case TaskStatus::YIELD:
+        // Início do próprio deque: roda depois das demais tarefas locais e é a primeira a ser roubada
+        enqueue(me, task, true);
+        break;
+    case TaskStatus::DONE:
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        --remaining;
+        --started;
+        break;
+    }
+    case TaskStatus::POLL:
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        queued.fetch_add(1);
+        pollingCount.fetch_add(1);
+        polling.push_back(task);
+        break;
+    }
+    case TaskStatus::BLOCKED:
+    {
+        std::unique_lock<std::mutex> lock(mtx);
+        // Quem satisfaz a condição notifica sob o mesmo mtx: reconferir aqui evita perder o aviso
+        if (task->ready())
+        {
+            lock.unlock();
+            enqueue(me, task, false);
+        }
+        else
+            park(task);
+        break;
+    }
+    }
+    active.fetch_sub(1);
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+    }
+    idle.notify_all();
+}
+
+void Scheduler::park(GreenTask *task)
+{
+    const std::vector<const void *> *keys = task->waitKeys();
+    if (keys && !keys->empty())
+    {
+        for (const void *key : *keys)
+            parked[key].push_back(task);
+        multiParked[task] = *keys;
+    }
+    else
+        parked[task->waitKey()].push_back(task);
+    ++parkedCount;
+}
+
+void Scheduler::breakDeadlock(size_t me)
+{
+    // Ninguém em execução nem na fila: nenhuma tarefa estacionada pode mais ser satisfeita
+    std::unordered_set<GreenTask *> released; // tarefa em várias chaves é liberada uma vez só
+    for (auto &entry : parked)
+        for (GreenTask *task : entry.second)
+        {
+            if (!released.insert(task).second)
+                continue;
+            task->release();
+            enqueue(me, task, false);
+        }
+    parked.clear();
+    multiParked.clear();
+    parkedCount = 0;
+    idle.notify_all();
+}
+
+void Scheduler::notify(const void *key)
+{
+    std::vector<GreenTask *> woken;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        auto it = parked.find(key);
+        if (it == parked.end())
+            return;
+        woken.swap(it->second);
+        parked.erase(it);
+        parkedCount -= woken.size();
+        for (GreenTask *task : woken)
+        {
+            auto multi = multiParked.find(task);
+            if (multi == multiParked.end())
+                continue;
+            for (const void *other : multi->second)
+            {
+                auto list = parked.find(other);
+                if (other == key || list == parked.end())
+                    continue;
+                list->second.erase(std::remove(list->second.begin(), list->second.end(), task), list->second.end());
+                if (list->second.empty())
+                    parked.erase(list);
+            }
+            multiParked.erase(multi);
+        }
+    }
+    size_t me = currentScheduler == this ? currentWorker : 0;
+    for (GreenTask *task : woken)
+        push(me, task, false);
+}
+
+void Scheduler::workerLoop(size_t me)
+{
+    currentScheduler = this;
+    currentWorker = me;
+    for (;;)
+    {
+        if (GreenTask *task = take(me))
+        {
+            execute(me, task);
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(mtx);
+        if (remaining == 0)
+            break;
+        if (queued.load() > 0)
+            continue;
+        if (active.load() == 0 && parkedCount > 0)
+        {
+            breakDeadlock(me);
+            continue;
+        }
+        idle.wait(lock);
+    }
+    currentScheduler = nullptr;
+}
+
+void Scheduler::runAll(const std::vector<GreenTask *> &tasks)
+{
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        injection.assign(tasks.begin(), tasks.end());
+        remaining = tasks.size();
+        started = peakStarted = 0;
+        queued.store(tasks.size());
+    }
+    std::vector<std::function<void()>> loops;
+    for (size_t k = 0; k < deques.size(); ++k)
+        loops.push_back([this, k]
+                        { workerLoop(k); });
+    ThreadPool::shared().runAll(loops);
+}
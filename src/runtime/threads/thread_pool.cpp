@@ -0,0 +1,100 @@
+#include "thread_pool.h"
+#include <exception>
+
+ThreadPool::ThreadPool(size_t count)
+{
+    if (count == 0)
+        count = std::thread::hardware_concurrency();
+    if (count == 0)
+        count = 1;
+    workers.reserve(count);
+    for (size_t k = 0; k < count; ++k)
+        workers.emplace_back([this]
+                             { workerLoop(); });
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto &t : workers)
+        t.join();
+}
+
+ThreadPool &ThreadPool::shared()
+{
+    static ThreadPool pool;
+    return pool;
+}
+
+bool ThreadPool::runOne(std::unique_lock<std::mutex> &lock)
+{
+    if (queue.empty())
+        return false;
+    std::function<void()> task = std::move(queue.front());
+    queue.pop_front();
+    lock.unlock();
+    task();
+    lock.lock();
+    return true;
+}
+
+void ThreadPool::workerLoop()
+{
+    std::unique_lock<std::mutex> lock(mtx);
+    for (;;)
+    {
+        wake.wait(lock, [this]
+                  { return stopping || !queue.empty(); });
+        if (queue.empty())
+            return; // encerrando e sem trabalho pendente
+        runOne(lock);
+    }
+}
+
+void ThreadPool::runAll(std::vector<std::function<void()>> &tasks)
+{
+    if (tasks.empty())
+        return;
+    size_t pending = tasks.size();
+    std::exception_ptr failure;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        for (auto &task : tasks)
+        {
+            // Cada tarefa avisa o término (sob o mutex do pool) e guarda a primeira exceção
+            queue.emplace_back([this, &task, &pending, &failure]
+                               {
+                std::exception_ptr error;
+                try
+                {
+                    task();
+                }
+                catch (...)
+                {
+                    error = std::current_exception();
+                }
+                std::lock_guard<std::mutex> guard(mtx);
+                if (error && !failure)
+                    failure = error;
+                if (--pending == 0)
+                    done.notify_all(); });
+        }
+    }
+    wake.notify_all();
+
+    // Join: a thread chamadora ajuda a esvaziar a fila e depois espera as tarefas em andamento
+    std::unique_lock<std::mutex> lock(mtx);
+    while (pending > 0)
+    {
+        if (!runOne(lock))
+            done.wait(lock, [&]
+                      { return pending == 0 || !queue.empty(); });
+    }
+    lock.unlock();
+    if (failure)
+        std::rethrow_exception(failure);
+}